@@ -0,0 +1,126 @@
+#ifndef AFFINETRANSFORM_H_
+#define AFFINETRANSFORM_H_
+
+#include "Direction.h"
+#include "DoubleComparison.h"
+#include "Matrix.h"
+#include "Operators.h"
+#include "Point.h"
+
+#include <ostream>
+#include <stdexcept>
+
+
+template <typename T>
+struct BasicAffineTransform : operators::equality_comparable<BasicAffineTransform<T>> {
+	Matrix<3, 4, T> matrix;
+
+	constexpr BasicAffineTransform() :
+			matrix{
+				T(1), T(0), T(0), T(0),
+				T(0), T(1), T(0), T(0),
+				T(0), T(0), T(1), T(0)
+			} {
+	}
+
+	constexpr explicit BasicAffineTransform(Matrix<3, 4, T> const & matrix) :
+			matrix{matrix} {
+	}
+
+	constexpr explicit BasicAffineTransform(Matrix<4, 4, T> const & matrix) :
+			matrix{} {
+		auto const & m = matrix.values;
+		if (!isEqual(m[12], T(0)) || !isEqual(m[13], T(0)) || !isEqual(m[14], T(0)) || !isEqual(m[15], T(1))) {
+			throw std::invalid_argument{"Matrix with a bottom row other than 0, 0, 0, 1 is not affine"};
+		}
+		for (auto index = 0u; index < 12; ++index) {
+			this->matrix.values[index] = m[index];
+		}
+	}
+
+	constexpr Matrix<3, 3, T> linear() const {
+		auto const & m = matrix.values;
+		return {
+			m[0], m[1], m[2],
+			m[4], m[5], m[6],
+			m[8], m[9], m[10]
+		};
+	}
+
+	constexpr BasicDirection<T> translation() const {
+		auto const & m = matrix.values;
+		return {m[3], m[7], m[11]};
+	}
+
+	constexpr Matrix<4, 4, T> toMatrix() const {
+		auto const & m = matrix.values;
+		return {
+			m[0], m[1], m[2], m[3],
+			m[4], m[5], m[6], m[7],
+			m[8], m[9], m[10], m[11],
+			T(0), T(0), T(0), T(1)
+		};
+	}
+
+	constexpr bool operator==(BasicAffineTransform const & other) const {
+		return matrix == other.matrix;
+	}
+};
+
+using AffineTransform = BasicAffineTransform<double>;
+using AffineTransformF = BasicAffineTransform<float>;
+
+template <typename T>
+constexpr BasicAffineTransform<T> operator*(BasicAffineTransform<T> const & lhs, BasicAffineTransform<T> const & rhs) {
+	auto const & a = lhs.matrix.values;
+	auto const & b = rhs.matrix.values;
+	Matrix<3, 4, T> result{};
+	for (auto row = 0u; row < 3; ++row) {
+		T const * const lhsRow = a.data() + row * 4;
+		for (auto column = 0u; column < 4; ++column) {
+			result.values[row * 4 + column] = lhsRow[0] * b[column] + lhsRow[1] * b[4 + column] + lhsRow[2] * b[8 + column];
+		}
+		result.values[row * 4 + 3] += lhsRow[3];
+	}
+	return BasicAffineTransform<T>{result};
+}
+
+template <typename T>
+constexpr BasicPoint<T> operator*(BasicAffineTransform<T> const & transform, BasicPoint<T> const & point) {
+	auto const & m = transform.matrix.values;
+	return {
+		m[0] * point.x + m[1] * point.y + m[2] * point.z + m[3],
+		m[4] * point.x + m[5] * point.y + m[6] * point.z + m[7],
+		m[8] * point.x + m[9] * point.y + m[10] * point.z + m[11]
+	};
+}
+
+template <typename T>
+constexpr BasicDirection<T> operator*(BasicAffineTransform<T> const & transform, BasicDirection<T> const & direction) {
+	auto const & m = transform.matrix.values;
+	return {
+		m[0] * direction.x + m[1] * direction.y + m[2] * direction.z,
+		m[4] * direction.x + m[5] * direction.y + m[6] * direction.z,
+		m[8] * direction.x + m[9] * direction.y + m[10] * direction.z
+	};
+}
+
+template <typename T>
+constexpr BasicAffineTransform<T> inverse(BasicAffineTransform<T> const & transform) {
+	auto const linearInverse = inverse(transform.linear());
+	auto const & l = linearInverse.values;
+	auto const t = transform.translation();
+	return BasicAffineTransform<T>{Matrix<3, 4, T>{
+		l[0], l[1], l[2], -(l[0] * t.x + l[1] * t.y + l[2] * t.z),
+		l[3], l[4], l[5], -(l[3] * t.x + l[4] * t.y + l[5] * t.z),
+		l[6], l[7], l[8], -(l[6] * t.x + l[7] * t.y + l[8] * t.z)
+	}};
+}
+
+template <typename T>
+std::ostream & operator<<(std::ostream & out, BasicAffineTransform<T> const & transform) {
+	return out << "AffineTransform " << transform.matrix;
+}
+
+
+#endif /* AFFINETRANSFORM_H_ */
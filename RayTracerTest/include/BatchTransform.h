@@ -0,0 +1,157 @@
+#ifndef BATCHTRANSFORM_H_
+#define BATCHTRANSFORM_H_
+
+#include "Direction.h"
+#include "Matrix.h"
+#include "MatrixKernels.h"
+#include "Point.h"
+#include "Span.h"
+#include "Transformations.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+// Non-owning view of coordinates stored as separate x, y and z arrays.
+template <typename T>
+struct CoordinateSpans {
+	Span<T> x;
+	Span<T> y;
+	Span<T> z;
+
+	constexpr CoordinateSpans(Span<T> const x, Span<T> const y, Span<T> const z) :
+			x{x}, y{y}, z{z} {
+		if (x.size() != y.size() || x.size() != z.size()) {
+			throw std::invalid_argument{"Coordinate arrays must have the same size"};
+		}
+	}
+
+	template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+	constexpr CoordinateSpans(CoordinateSpans<U> const & other) :
+			x{other.x}, y{other.y}, z{other.z} {
+	}
+
+	constexpr std::size_t size() const noexcept {
+		return x.size();
+	}
+};
+
+template <typename T>
+struct CoordinateArrays {
+	std::vector<T> x;
+	std::vector<T> y;
+	std::vector<T> z;
+
+	explicit CoordinateArrays(std::size_t const size = 0) :
+			x(size), y(size), z(size) {
+	}
+
+	template <typename Coordinate>
+	explicit CoordinateArrays(std::vector<Coordinate> const & coordinates) :
+			CoordinateArrays(coordinates.size()) {
+		for (std::size_t index = 0; index < coordinates.size(); ++index) {
+			x[index] = coordinates[index].x;
+			y[index] = coordinates[index].y;
+			z[index] = coordinates[index].z;
+		}
+	}
+
+	std::size_t size() const noexcept {
+		return x.size();
+	}
+
+	CoordinateSpans<T> spans() {
+		return {x, y, z};
+	}
+
+	CoordinateSpans<T const> spans() const {
+		return {x, y, z};
+	}
+};
+
+namespace {
+
+template <typename In, typename Out>
+constexpr void checkBatchSizes(In const & in, Out const & out) {
+	if (in.size() != out.size()) {
+		throw std::invalid_argument{"Batch transform output must have the size of the input"};
+	}
+}
+
+template <typename T, typename A, typename Target>
+constexpr void transformEach(Matrix<4, 4, T, A> const & matrix, Span<Target const> const in, Span<Target> const out) {
+	checkBatchSizes(in, out);
+	for (std::size_t index = 0; index < in.size(); ++index) {
+		out[index] = matrix * in[index];
+	}
+}
+
+template <typename T, typename A>
+void transformCoordinates(Matrix<4, 4, T, A> const & matrix, T const w, CoordinateSpans<T const> const in, CoordinateSpans<T> const out, std::size_t const begin, std::size_t const end) noexcept {
+	auto const * const m = matrix.values.data();
+	if constexpr (std::is_same_v<T, double>) {
+		kernels::active().transform(m, w, in.x.data() + begin, in.y.data() + begin, in.z.data() + begin, out.x.data() + begin, out.y.data() + begin, out.z.data() + begin, end - begin);
+	} else {
+		for (auto index = begin; index < end; ++index) {
+			T const px = in.x[index];
+			T const py = in.y[index];
+			T const pz = in.z[index];
+			out.x[index] = m[0] * px + m[1] * py + m[2] * pz + m[3] * w;
+			out.y[index] = m[4] * px + m[5] * py + m[6] * pz + m[7] * w;
+			out.z[index] = m[8] * px + m[9] * py + m[10] * pz + m[11] * w;
+		}
+	}
+}
+
+template <typename T, typename A>
+void transformCoordinates(Matrix<4, 4, T, A> const & matrix, T const w, CoordinateSpans<T const> const in, CoordinateSpans<T> const out, std::size_t const threads) {
+	checkBatchSizes(in, out);
+	constexpr std::size_t kMinimumChunk{4096};
+	auto const count = in.size();
+	auto const workers = std::max<std::size_t>(1, std::min(threads, count / kMinimumChunk));
+	auto const chunk = (count + workers - 1) / workers;
+	std::vector<std::thread> helpers{};
+	helpers.reserve(workers - 1);
+	for (auto worker = 1u; worker < workers; ++worker) {
+		auto const begin = worker * chunk;
+		auto const end = std::min(count, begin + chunk);
+		helpers.emplace_back([&matrix, w, in, out, begin, end] {
+			transformCoordinates(matrix, w, in, out, begin, end);
+		});
+	}
+	transformCoordinates(matrix, w, in, out, 0, std::min(count, chunk));
+	for (auto & helper : helpers) {
+		helper.join();
+	}
+}
+
+}
+
+template <typename T, typename A>
+constexpr void transformPoints(Matrix<4, 4, T, A> const & matrix, NonDeduced<Span<BasicPoint<T> const>> const in, NonDeduced<Span<BasicPoint<T>>> const out) {
+	transformEach(matrix, in, out);
+}
+
+template <typename T, typename A>
+constexpr void transformDirections(Matrix<4, 4, T, A> const & matrix, NonDeduced<Span<BasicDirection<T> const>> const in, NonDeduced<Span<BasicDirection<T>>> const out) {
+	transformEach(matrix, in, out);
+}
+
+// Structure-of-arrays variants; in and out may be the same arrays. Batches
+// large enough are split across up to threads threads.
+template <typename T, typename A>
+void transformPoints(Matrix<4, 4, T, A> const & matrix, NonDeduced<CoordinateSpans<T const>> const in, NonDeduced<CoordinateSpans<T>> const out, std::size_t const threads = 1) {
+	transformCoordinates(matrix, T(1), in, out, threads);
+}
+
+template <typename T, typename A>
+void transformDirections(Matrix<4, 4, T, A> const & matrix, NonDeduced<CoordinateSpans<T const>> const in, NonDeduced<CoordinateSpans<T>> const out, std::size_t const threads = 1) {
+	transformCoordinates(matrix, T(0), in, out, threads);
+}
+
+
+#endif /* BATCHTRANSFORM_H_ */
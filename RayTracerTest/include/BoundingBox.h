@@ -0,0 +1,139 @@
+#ifndef BOUNDINGBOX_H_
+#define BOUNDINGBOX_H_
+
+#include "Direction.h"
+#include "Matrix.h"
+#include "Point.h"
+#include "Ray.h"
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+
+
+// Axis aligned bounding box; a default constructed box is empty.
+template <typename T>
+struct BasicBoundingBox {
+	BasicPoint<T> min{std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity()};
+	BasicPoint<T> max{-std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity()};
+
+	constexpr BasicBoundingBox() = default;
+
+	constexpr BasicBoundingBox(BasicPoint<T> const & min, BasicPoint<T> const & max) :
+			min{min}, max{max} {
+	}
+
+	constexpr bool empty() const noexcept {
+		return min.x > max.x || min.y > max.y || min.z > max.z;
+	}
+
+	constexpr BasicBoundingBox & extend(BasicPoint<T> const & point) noexcept {
+		min = {std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z)};
+		max = {std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z)};
+		return *this;
+	}
+
+	constexpr BasicBoundingBox & extend(BasicBoundingBox const & other) noexcept {
+		if (!other.empty()) {
+			extend(other.min);
+			extend(other.max);
+		}
+		return *this;
+	}
+
+	constexpr BasicDirection<T> extent() const noexcept {
+		return empty() ? BasicDirection<T>{} : max - min;
+	}
+
+	constexpr BasicPoint<T> centroid() const noexcept {
+		return min + (max - min) * T(0.5);
+	}
+
+	constexpr T surfaceArea() const noexcept {
+		auto const size = extent();
+		return T(2) * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	constexpr bool contains(BasicBoundingBox const & other) const noexcept {
+		return other.empty() || (min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z
+				&& max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z);
+	}
+};
+
+using BoundingBox = BasicBoundingBox<double>;
+using BoundingBoxF = BasicBoundingBox<float>;
+
+template <typename T>
+constexpr T component(BasicPoint<T> const & point, unsigned const axis) noexcept {
+	return axis == 0 ? point.x : axis == 1 ? point.y : point.z;
+}
+
+template <typename T>
+constexpr T component(BasicDirection<T> const & direction, unsigned const axis) noexcept {
+	return axis == 0 ? direction.x : axis == 1 ? direction.y : direction.z;
+}
+
+// World space box around a transformed box (Arvo's method). Each world axis
+// takes the extremes of the matrix row times the box extent, column by
+// column, so rotation and shear are handled without transforming corners.
+template <typename T, typename A>
+constexpr BasicBoundingBox<T> transformed(Matrix<4, 4, T, A> const & matrix, BasicBoundingBox<T> const & box) {
+	if (box.empty()) {
+		return box;
+	}
+	auto const & m = matrix.values;
+	T minimum[3]{};
+	T maximum[3]{};
+	for (auto row = 0u; row < 3; ++row) {
+		minimum[row] = maximum[row] = m[row * 4 + 3];
+		for (auto column = 0u; column < 3; ++column) {
+			auto const first = m[row * 4 + column] * component(box.min, column);
+			auto const second = m[row * 4 + column] * component(box.max, column);
+			minimum[row] += std::min(first, second);
+			maximum[row] += std::max(first, second);
+		}
+	}
+	return {{minimum[0], minimum[1], minimum[2]}, {maximum[0], maximum[1], maximum[2]}};
+}
+
+// Slab test of the ray origin + t * direction against box, restricted to
+// [tMin, tMax]. Takes the reciprocal of the direction, so callers testing
+// many boxes compute it once. On a hit, entry receives the entry time.
+template <typename T>
+constexpr bool intersects(BasicBoundingBox<T> const & box, BasicPoint<T> const & origin, BasicDirection<T> const & inverseDirection, T tMin, T tMax, T & entry) noexcept {
+	for (auto axis = 0u; axis < 3; ++axis) {
+		auto const first = (component(box.min, axis) - component(origin, axis)) * component(inverseDirection, axis);
+		auto const second = (component(box.max, axis) - component(origin, axis)) * component(inverseDirection, axis);
+		tMin = std::max(tMin, std::min(first, second));
+		tMax = std::min(tMax, std::max(first, second));
+	}
+	entry = tMin;
+	return tMin <= tMax;
+}
+
+// The same slab test for a precomputed ray, whose direction signs select
+// the near and far plane of each slab instead of comparing both.
+template <typename T>
+constexpr bool intersects(BasicBoundingBox<T> const & box, BasicPrecomputedRay<T> const & ray, T tMin, T tMax, T & entry) noexcept {
+	for (auto axis = 0u; axis < 3; ++axis) {
+		auto const & near = ray.sign[axis] ? box.max : box.min;
+		auto const & far = ray.sign[axis] ? box.min : box.max;
+		tMin = std::max(tMin, (component(near, axis) - component(ray.origin, axis)) * component(ray.inverseDirection, axis));
+		tMax = std::min(tMax, (component(far, axis) - component(ray.origin, axis)) * component(ray.inverseDirection, axis));
+	}
+	entry = tMin;
+	return tMin <= tMax;
+}
+
+template <typename T>
+constexpr bool intersects(BasicBoundingBox<T> const & box, BasicPrecomputedRay<T> const & ray, T & entry) noexcept {
+	return intersects(box, ray, ray.tMin, ray.tMax, entry);
+}
+
+template <typename T>
+std::ostream & operator<<(std::ostream & out, BasicBoundingBox<T> const & box) {
+	return out << "BoundingBox{" << box.min << ", " << box.max << '}';
+}
+
+
+#endif /* BOUNDINGBOX_H_ */
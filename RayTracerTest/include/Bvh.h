@@ -0,0 +1,673 @@
+#ifndef BVH_H_
+#define BVH_H_
+
+#include "BoundingBox.h"
+#include "Direction.h"
+#include "Point.h"
+#include "Ray.h"
+#include "Span.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+struct BvhTraversalCounters {
+	std::size_t nodesVisited{};
+	std::size_t primitivesVisited{};
+
+	constexpr BvhTraversalCounters & operator+=(BvhTraversalCounters const & other) noexcept {
+		nodesVisited += other.nodesVisited;
+		primitivesVisited += other.primitivesVisited;
+		return *this;
+	}
+};
+
+// Half a cache line: single precision bounds, rounded outwards, plus the
+// link to the rest of the tree. Nodes are stored depth first, so the left
+// child of an interior node directly follows it.
+struct alignas(32) BvhNode {
+	std::array<float, 3> min;
+	std::array<float, 3> max;
+	// Interior nodes: index of the right child. Leaves: first primitive.
+	std::uint32_t offset;
+	// Number of primitives of a leaf, 0 for interior nodes.
+	std::uint16_t count;
+	std::uint16_t axis;
+
+	constexpr bool leaf() const noexcept {
+		return count != 0;
+	}
+
+	template <typename T>
+	constexpr BasicBoundingBox<T> bounds() const noexcept {
+		return {{T(min[0]), T(min[1]), T(min[2])}, {T(max[0]), T(max[1]), T(max[2])}};
+	}
+};
+
+static_assert(sizeof(BvhNode) == 32, "BvhNode must stay half a cache line");
+
+template <typename T>
+struct BasicBvhBuildStatistics {
+	double milliseconds{};
+	std::size_t nodeCount{};
+	// Expected cost of a ray entering the root under the surface area
+	// heuristic, in units of primitive intersections.
+	T sahCost{};
+};
+
+template <typename T>
+struct BasicBvhRefitStatistics {
+	std::size_t nodesRefitted{};
+	std::size_t primitivesRebuilt{};
+	T sahCost{};
+};
+
+namespace {
+
+// Runs task(chunk, begin, end) over [0, count) split into up to threads chunks.
+template <typename Task>
+void forEachChunk(std::size_t const count, std::size_t const threads, Task const & task) {
+	auto const workers = std::max<std::size_t>(1, std::min(threads, count));
+	auto const chunk = (count + workers - 1) / workers;
+	std::vector<std::thread> helpers{};
+	helpers.reserve(workers - 1);
+	for (std::size_t worker = 1; worker < workers; ++worker) {
+		auto const begin = std::min(count, worker * chunk);
+		auto const end = std::min(count, begin + chunk);
+		helpers.emplace_back([&task, worker, begin, end] {
+			task(worker, begin, end);
+		});
+	}
+	task(0, 0, std::min(count, chunk));
+	for (auto & helper : helpers) {
+		helper.join();
+	}
+}
+
+}
+
+// Bounding volume hierarchy over shape bounds, built top down with the
+// surface area heuristic evaluated at a fixed number of bins per node.
+template <typename T>
+class BasicBvh {
+public:
+	static constexpr std::size_t kBins{16};
+	static constexpr std::size_t kMaximumLeafSize{8};
+	// Cost of visiting a node relative to intersecting one primitive.
+	static constexpr T kTraversalCost{T(1)};
+	// Bounds the traversal stack. Below kBalancedDepth the build falls back
+	// to median splits, which finish any 32-bit primitive count in time.
+	static constexpr std::size_t kMaximumDepth{64};
+	static constexpr std::size_t kBalancedDepth{kMaximumDepth - 32};
+	// With more than one thread, subtrees at least this large build as
+	// separate tasks and nodes at least kParallelBinningSize large bin in
+	// parallel. The tree does not depend on the number of threads.
+	static constexpr std::size_t kParallelSubtreeSize{1 << 12};
+	static constexpr std::size_t kParallelBinningSize{1 << 16};
+	// Rebuilding subtrees that hold more of the primitives than this costs
+	// about as much as building the whole tree, which rebuild() does instead.
+	static constexpr T kMaximumRebuiltShare{T(0.5)};
+
+	BasicBvh() = default;
+
+	explicit BasicBvh(std::vector<BasicBoundingBox<T>> const & shapeBounds, std::size_t threads = 1) :
+			shapes_(shapeBounds.size()), primitiveBounds_(shapeBounds.size()), centroids_(shapeBounds.size()) {
+		auto const start = std::chrono::steady_clock::now();
+		threads = std::max<std::size_t>(1, threads);
+		threads_ = threads;
+		std::iota(shapes_.begin(), shapes_.end(), std::uint32_t{0});
+		forEachChunk(shapeBounds.size(), threads, [&](std::size_t, std::size_t const begin, std::size_t const end) {
+			for (auto index = begin; index < end; ++index) {
+				centroids_[index] = shapeBounds[index].centroid();
+			}
+		});
+		if (!shapes_.empty()) {
+			nodes_.reserve(2 * shapes_.size());
+			build(shapeBounds, nodes_, 0, static_cast<std::uint32_t>(shapes_.size()), 0, threads);
+		}
+		forEachChunk(shapes_.size(), threads, [&](std::size_t, std::size_t const begin, std::size_t const end) {
+			for (auto index = begin; index < end; ++index) {
+				primitiveBounds_[index] = shapeBounds[shapes_[index]];
+			}
+		});
+		centroids_ = {};
+		index();
+		referenceAreas_.resize(nodes_.size());
+		for (std::size_t node = 0; node < nodes_.size(); ++node) {
+			referenceAreas_[node] = nodes_[node].bounds<T>().surfaceArea();
+		}
+		referenceSahCost_ = sahCost();
+		statistics_.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		statistics_.nodeCount = nodes_.size();
+		statistics_.sahCost = referenceSahCost_;
+	}
+
+	std::size_t size() const noexcept {
+		return shapes_.size();
+	}
+
+	std::vector<BvhNode> const & nodes() const noexcept {
+		return nodes_;
+	}
+
+	std::size_t nodeCount() const noexcept {
+		return nodes_.size();
+	}
+
+	BasicBvhBuildStatistics<T> const & statistics() const noexcept {
+		return statistics_;
+	}
+
+	// Threads the tree was built with, which rebuild() uses again.
+	std::size_t threads() const noexcept {
+		return threads_;
+	}
+
+	// Current SAH cost, kept up to date by refit().
+	T sahCost() const noexcept {
+		if (nodes_.empty()) {
+			return T(0);
+		}
+		auto const rootArea = nodes_[0].bounds<T>().surfaceArea();
+		if (rootArea <= T(0)) {
+			return T(nodes_[0].leaf() ? nodes_[0].count : size());
+		}
+		return weightedArea_ / rootArea;
+	}
+
+	// SAH cost when the whole tree was last built. Rebuilding subtrees
+	// leaves it as it is, so degradation is measured against a full build.
+	T referenceSahCost() const noexcept {
+		return referenceSahCost_;
+	}
+
+	// Takes the bounds of the given primitives from shapeBounds, indexed by
+	// shape, and recomputes the bounds of their leaves and ancestors bottom
+	// up. Stops climbing where bounds do not change, so the work is
+	// proportional to the primitives moved. Returns the nodes it changed.
+	std::vector<std::uint32_t> refit(Span<std::uint32_t const> const primitives, std::vector<BasicBoundingBox<T>> const & shapeBounds) {
+		for (auto const primitive : primitives) {
+			primitiveBounds_[primitive] = shapeBounds[shapes_[primitive]];
+		}
+		std::vector<std::uint32_t> refitted{};
+		for (auto const primitive : primitives) {
+			auto node = leaves_[primitive];
+			BasicBoundingBox<T> bounds{};
+			for (auto index = nodes_[node].offset; index < nodes_[node].offset + nodes_[node].count; ++index) {
+				bounds.extend(primitiveBounds_[index]);
+			}
+			auto updated = nodes_[node];
+			updated.min = {roundDown(bounds.min.x), roundDown(bounds.min.y), roundDown(bounds.min.z)};
+			updated.max = {roundUp(bounds.max.x), roundUp(bounds.max.y), roundUp(bounds.max.z)};
+			while (replaceBounds(node, updated)) {
+				refitted.push_back(node);
+				refittedSinceBuild_.push_back(node);
+				if (node == 0) {
+					break;
+				}
+				node = parents_[node];
+				auto const & left = nodes_[node + 1];
+				auto const & right = nodes_[nodes_[node].offset];
+				updated = nodes_[node];
+				for (auto axis = 0u; axis < 3; ++axis) {
+					updated.min[axis] = std::min(left.min[axis], right.min[axis]);
+					updated.max[axis] = std::max(left.max[axis], right.max[axis]);
+				}
+			}
+		}
+		if (refittedSinceBuild_.size() > nodes_.size()) {
+			std::sort(refittedSinceBuild_.begin(), refittedSinceBuild_.end());
+			refittedSinceBuild_.erase(std::unique(refittedSinceBuild_.begin(), refittedSinceBuild_.end()), refittedSinceBuild_.end());
+		}
+		return refitted;
+	}
+
+	// Rebuilds the topmost refitted subtrees whose surface area grew by more
+	// than maximumGrowth since they were built. Rebuilds the whole tree
+	// instead if the root grew that much, if no subtree did, if those
+	// subtrees hold more than kMaximumRebuiltShare of the primitives, or if
+	// rebuilding them leaves the SAH cost above maximumGrowth times
+	// referenceSahCost(). A subtree can only regroup its own primitives, so
+	// shapes that moved far apart are only regathered by a full build.
+	// shapeBounds is indexed by shape. Returns the number of primitives in
+	// rebuilt subtrees.
+	std::size_t rebuild(std::vector<BasicBoundingBox<T>> const & shapeBounds, T const maximumGrowth) {
+		if (nodes_.empty()) {
+			return 0;
+		}
+		std::vector<std::uint32_t> grown{};
+		for (auto const node : refittedSinceBuild_) {
+			if (nodes_[node].bounds<T>().surfaceArea() > maximumGrowth * referenceAreas_[node]) {
+				grown.push_back(node);
+			}
+		}
+		std::sort(grown.begin(), grown.end());
+		grown.erase(std::unique(grown.begin(), grown.end()), grown.end());
+		std::vector<std::uint32_t> degraded{};
+		for (auto const node : grown) {
+			auto covered = false;
+			for (auto ancestor = node; ancestor != 0 && !covered;) {
+				ancestor = parents_[ancestor];
+				covered = std::binary_search(grown.begin(), grown.end(), ancestor);
+			}
+			if (!covered) {
+				degraded.push_back(node);
+			}
+		}
+		std::size_t degradedPrimitives{};
+		for (auto const node : degraded) {
+			auto const [first, last] = primitiveRange(node);
+			degradedPrimitives += last - first;
+		}
+		if (degraded.empty() || degraded.front() == 0 || degradedPrimitives > kMaximumRebuiltShare * size()) {
+			*this = BasicBvh{shapeBounds, threads_};
+			return size();
+		}
+		// Splicing a subtree moves only the nodes after it, so later
+		// subtrees go first and the indices of earlier ones stay valid.
+		std::reverse(degraded.begin(), degraded.end());
+		std::vector<std::size_t> depths{};
+		for (auto const node : degraded) {
+			std::size_t depth{};
+			for (auto ancestor = node; ancestor != 0; ancestor = parents_[ancestor]) {
+				++depth;
+			}
+			depths.push_back(depth);
+		}
+		centroids_.resize(shapeBounds.size());
+		std::size_t rebuilt{};
+		for (std::size_t index = 0; index < degraded.size(); ++index) {
+			rebuilt += rebuildSubtree(shapeBounds, degraded[index], depths[index]);
+		}
+		centroids_ = {};
+		refittedSinceBuild_.clear();
+		index();
+		if (sahCost() > maximumGrowth * referenceSahCost_) {
+			*this = BasicBvh{shapeBounds, threads_};
+			return size();
+		}
+		return rebuilt;
+	}
+
+	// Shape index of each primitive; leaves refer to ranges of primitives.
+	std::vector<std::uint32_t> const & shapes() const noexcept {
+		return shapes_;
+	}
+
+	// Exact bounds of each primitive, in leaf order.
+	BasicBoundingBox<T> const & primitiveBounds(std::uint32_t const primitive) const noexcept {
+		return primitiveBounds_[primitive];
+	}
+
+	// Calls visit(primitive, tMax) for every primitive whose leaf the ray
+	// enters within [ray.tMin, ray.tMax]. visit returns the new tMax, so a
+	// closest hit query can shrink the interval, or a value below tMin to
+	// end the traversal. Of two children the ray enters, the one on the side
+	// of the split the ray comes from is visited first.
+	template <typename Visitor>
+	BvhTraversalCounters traverse(BasicPrecomputedRay<T> const & ray, Visitor && visit) const {
+		BvhTraversalCounters counters{};
+		if (nodes_.empty()) {
+			return counters;
+		}
+		auto const tMin = ray.tMin;
+		auto tMax = ray.tMax;
+		T entry{};
+		++counters.nodesVisited;
+		if (!intersects(nodes_[0].bounds<T>(), ray, tMin, tMax, entry)) {
+			return counters;
+		}
+		// Uninitialised: zeroing them would cost more than many short
+		// traversals. Only the slots below stackSize are read.
+		std::array<std::uint32_t, kMaximumDepth> stack;
+		std::array<T, kMaximumDepth> stackEntry;
+		std::size_t stackSize{};
+		std::uint32_t current{0};
+		while (true) {
+			auto const & node = nodes_[current];
+			if (node.leaf()) {
+				counters.primitivesVisited += node.count;
+				for (auto primitive = node.offset; primitive < node.offset + node.count; ++primitive) {
+					tMax = visit(primitive, tMax);
+					if (tMax < tMin) {
+						return counters;
+					}
+				}
+			} else {
+				std::uint32_t const left = current + 1;
+				std::uint32_t const right = node.offset;
+				T leftEntry{};
+				T rightEntry{};
+				counters.nodesVisited += 2;
+				bool const hitsLeft = intersects(nodes_[left].bounds<T>(), ray, tMin, tMax, leftEntry);
+				bool const hitsRight = intersects(nodes_[right].bounds<T>(), ray, tMin, tMax, rightEntry);
+				if (hitsLeft && hitsRight) {
+					// The left child holds the lower centroids along the split axis.
+					bool const leftFirst = ray.sign[node.axis] == 0;
+					stack[stackSize] = leftFirst ? right : left;
+					stackEntry[stackSize++] = leftFirst ? rightEntry : leftEntry;
+					current = leftFirst ? left : right;
+					continue;
+				}
+				if (hitsLeft || hitsRight) {
+					current = hitsLeft ? left : right;
+					continue;
+				}
+			}
+			do {
+				if (stackSize == 0) {
+					return counters;
+				}
+				current = stack[--stackSize];
+			} while (stackEntry[stackSize] > tMax);
+		}
+	}
+
+	template <typename Visitor>
+	BvhTraversalCounters traverse(BasicRay<T> const & ray, T const tMin, T const tMax, Visitor && visit) const {
+		return traverse(BasicPrecomputedRay<T>{ray, tMin, tMax}, visit);
+	}
+
+private:
+	std::vector<BvhNode> nodes_{};
+	std::vector<std::uint32_t> shapes_{};
+	std::vector<BasicBoundingBox<T>> primitiveBounds_{};
+	std::vector<BasicPoint<T>> centroids_{};
+	BasicBvhBuildStatistics<T> statistics_{};
+	std::size_t threads_{1};
+	// For refitting: the parent of each node, the leaf of each primitive,
+	// the area of each node when built and the sum of the node areas
+	// weighted by their SAH cost.
+	std::vector<std::uint32_t> parents_{};
+	std::vector<std::uint32_t> leaves_{};
+	std::vector<T> referenceAreas_{};
+	std::vector<std::uint32_t> refittedSinceBuild_{};
+	T weightedArea_{};
+	T referenceSahCost_{};
+
+	struct Bin {
+		BasicBoundingBox<T> bounds{};
+		std::uint32_t count{};
+	};
+
+	static T weight(BvhNode const & node) noexcept {
+		return node.leaf() ? T(node.count) : kTraversalCost;
+	}
+
+	void index() {
+		parents_.assign(nodes_.size(), 0);
+		leaves_.assign(shapes_.size(), 0);
+		weightedArea_ = T(0);
+		for (std::uint32_t node = 0; node < nodes_.size(); ++node) {
+			auto const & current = nodes_[node];
+			weightedArea_ += current.bounds<T>().surfaceArea() * weight(current);
+			if (current.leaf()) {
+				std::fill(leaves_.begin() + current.offset, leaves_.begin() + current.offset + current.count, node);
+			} else {
+				parents_[node + 1] = node;
+				parents_[current.offset] = node;
+			}
+		}
+	}
+
+	bool replaceBounds(std::uint32_t const node, BvhNode const & updated) noexcept {
+		auto & current = nodes_[node];
+		if (current.min == updated.min && current.max == updated.max) {
+			return false;
+		}
+		weightedArea_ += (updated.bounds<T>().surfaceArea() - current.bounds<T>().surfaceArea()) * weight(current);
+		current.min = updated.min;
+		current.max = updated.max;
+		return true;
+	}
+
+	std::uint32_t subtreeEnd(std::uint32_t node) const noexcept {
+		while (!nodes_[node].leaf()) {
+			node = nodes_[node].offset;
+		}
+		return node + 1;
+	}
+
+	// The contiguous range of primitives below node.
+	std::pair<std::uint32_t, std::uint32_t> primitiveRange(std::uint32_t const node) const noexcept {
+		auto first = std::numeric_limits<std::uint32_t>::max();
+		std::uint32_t last{};
+		auto const end = subtreeEnd(node);
+		for (auto index = node; index < end; ++index) {
+			if (nodes_[index].leaf()) {
+				first = std::min(first, nodes_[index].offset);
+				last = std::max(last, nodes_[index].offset + nodes_[index].count);
+			}
+		}
+		return {first, last};
+	}
+
+	// Replaces the subtree at node, which covers a contiguous range of
+	// primitives, by a fresh build over the same primitives.
+	std::size_t rebuildSubtree(std::vector<BasicBoundingBox<T>> const & shapeBounds, std::uint32_t const node, std::size_t const depth) {
+		auto const end = subtreeEnd(node);
+		auto const [first, last] = primitiveRange(node);
+		for (auto index = first; index < last; ++index) {
+			centroids_[shapes_[index]] = shapeBounds[shapes_[index]].centroid();
+		}
+		std::vector<BvhNode> subtree{};
+		build(shapeBounds, subtree, first, last, depth, threads_);
+		for (auto index = first; index < last; ++index) {
+			primitiveBounds_[index] = shapeBounds[shapes_[index]];
+		}
+
+		auto const shift = static_cast<std::int64_t>(subtree.size()) - static_cast<std::int64_t>(end - node);
+		for (std::size_t index = 0; index < nodes_.size(); ++index) {
+			if ((index < node || index >= end) && !nodes_[index].leaf() && nodes_[index].offset >= end) {
+				nodes_[index].offset = static_cast<std::uint32_t>(nodes_[index].offset + shift);
+			}
+		}
+		std::vector<T> areas{};
+		for (auto & built : subtree) {
+			if (!built.leaf()) {
+				built.offset += node;
+			}
+			areas.push_back(built.bounds<T>().surfaceArea());
+		}
+		nodes_.erase(nodes_.begin() + node, nodes_.begin() + end);
+		nodes_.insert(nodes_.begin() + node, subtree.begin(), subtree.end());
+		referenceAreas_.erase(referenceAreas_.begin() + node, referenceAreas_.begin() + end);
+		referenceAreas_.insert(referenceAreas_.begin() + node, areas.begin(), areas.end());
+		return last - first;
+	}
+
+	static float roundDown(T const value) noexcept {
+		auto const rounded = static_cast<float>(value);
+		return static_cast<T>(rounded) > value ? std::nextafter(rounded, -std::numeric_limits<float>::infinity()) : rounded;
+	}
+
+	static float roundUp(T const value) noexcept {
+		auto const rounded = static_cast<float>(value);
+		return static_cast<T>(rounded) < value ? std::nextafter(rounded, std::numeric_limits<float>::infinity()) : rounded;
+	}
+
+	static std::uint32_t emitNode(std::vector<BvhNode> & nodes, BasicBoundingBox<T> const & bounds) {
+		BvhNode node{};
+		node.min = {roundDown(bounds.min.x), roundDown(bounds.min.y), roundDown(bounds.min.z)};
+		node.max = {roundUp(bounds.max.x), roundUp(bounds.max.y), roundUp(bounds.max.z)};
+		nodes.push_back(node);
+		return static_cast<std::uint32_t>(nodes.size() - 1);
+	}
+
+	static void makeLeaf(std::vector<BvhNode> & nodes, std::uint32_t const node, std::uint32_t const begin, std::uint32_t const end) {
+		nodes[node].offset = begin;
+		nodes[node].count = static_cast<std::uint16_t>(end - begin);
+	}
+
+	// Appends a subtree built into its own array, relinking its interior nodes.
+	static void splice(std::vector<BvhNode> & nodes, std::vector<BvhNode> const & subtree) {
+		auto const base = static_cast<std::uint32_t>(nodes.size());
+		for (auto node : subtree) {
+			if (!node.leaf()) {
+				node.offset += base;
+			}
+			nodes.push_back(node);
+		}
+	}
+
+	void makeInterior(std::vector<BasicBoundingBox<T>> const & shapeBounds, std::vector<BvhNode> & nodes, std::uint32_t const node, std::uint32_t const begin, std::uint32_t const split, std::uint32_t const end, unsigned const axis, std::size_t const depth, std::size_t const threads) {
+		nodes[node].axis = static_cast<std::uint16_t>(axis);
+		if (threads == 1 || end - begin < kParallelSubtreeSize) {
+			build(shapeBounds, nodes, begin, split, depth + 1, 1);
+			nodes[node].offset = static_cast<std::uint32_t>(nodes.size());
+			build(shapeBounds, nodes, split, end, depth + 1, 1);
+			return;
+		}
+		// The subtrees own disjoint primitive ranges, so they build
+		// concurrently into separate arrays that are spliced in depth first order.
+		auto const leftThreads = threads / 2;
+		std::vector<BvhNode> left{};
+		auto leftTask = std::async(std::launch::async, [&] {
+			build(shapeBounds, left, begin, split, depth + 1, leftThreads);
+		});
+		std::vector<BvhNode> right{};
+		build(shapeBounds, right, split, end, depth + 1, threads - leftThreads);
+		leftTask.get();
+		splice(nodes, left);
+		nodes[node].offset = static_cast<std::uint32_t>(nodes.size());
+		splice(nodes, right);
+	}
+
+	// Bounds of the shapes in [begin, end) and of their centroids.
+	std::array<BasicBoundingBox<T>, 2> boundsOf(std::vector<BasicBoundingBox<T>> const & shapeBounds, std::uint32_t const begin, std::uint32_t const end, std::size_t const threads) const {
+		auto const accumulate = [&](std::size_t const first, std::size_t const last, std::array<BasicBoundingBox<T>, 2> & result) {
+			for (auto index = begin + first; index < begin + last; ++index) {
+				result[0].extend(shapeBounds[shapes_[index]]);
+				result[1].extend(centroids_[shapes_[index]]);
+			}
+		};
+		std::array<BasicBoundingBox<T>, 2> result{};
+		if (threads == 1) {
+			accumulate(0, end - begin, result);
+			return result;
+		}
+		std::vector<std::array<BasicBoundingBox<T>, 2>> partial(threads);
+		forEachChunk(end - begin, threads, [&](std::size_t const chunk, std::size_t const first, std::size_t const last) {
+			accumulate(first, last, partial[chunk]);
+		});
+		for (auto const & chunk : partial) {
+			result[0].extend(chunk[0]);
+			result[1].extend(chunk[1]);
+		}
+		return result;
+	}
+
+	template <typename BinOf>
+	std::array<Bin, kBins> binsOf(std::vector<BasicBoundingBox<T>> const & shapeBounds, std::uint32_t const begin, std::uint32_t const end, BinOf const & binOf, std::size_t const threads) const {
+		auto const accumulate = [&](std::size_t const first, std::size_t const last, std::array<Bin, kBins> & bins) {
+			for (auto index = begin + first; index < begin + last; ++index) {
+				auto & bin = bins[binOf(shapes_[index])];
+				bin.bounds.extend(shapeBounds[shapes_[index]]);
+				++bin.count;
+			}
+		};
+		std::array<Bin, kBins> bins{};
+		if (threads == 1) {
+			accumulate(0, end - begin, bins);
+			return bins;
+		}
+		std::vector<std::array<Bin, kBins>> partial(threads);
+		forEachChunk(end - begin, threads, [&](std::size_t const chunk, std::size_t const first, std::size_t const last) {
+			accumulate(first, last, partial[chunk]);
+		});
+		for (auto const & chunk : partial) {
+			for (std::size_t bin = 0; bin < kBins; ++bin) {
+				bins[bin].bounds.extend(chunk[bin].bounds);
+				bins[bin].count += chunk[bin].count;
+			}
+		}
+		return bins;
+	}
+
+	void build(std::vector<BasicBoundingBox<T>> const & shapeBounds, std::vector<BvhNode> & nodes, std::uint32_t const begin, std::uint32_t const end, std::size_t const depth, std::size_t const threads) {
+		auto const count = end - begin;
+		auto const binningThreads = count >= kParallelBinningSize ? threads : 1;
+		auto const [bounds, centroidBounds] = boundsOf(shapeBounds, begin, end, binningThreads);
+		auto const node = emitNode(nodes, bounds);
+		if (count == 1) {
+			return makeLeaf(nodes, node, begin, end);
+		}
+
+		auto const extent = centroidBounds.extent();
+		unsigned const axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+		auto const axisMin = component(centroidBounds.min, axis);
+		auto const axisExtent = component(extent, axis);
+		if (axisExtent <= T(0) || depth >= kBalancedDepth) {
+			if (count <= kMaximumLeafSize) {
+				return makeLeaf(nodes, node, begin, end);
+			}
+			return makeInterior(shapeBounds, nodes, node, begin, splitInMiddle(begin, end, axis), end, axis, depth, threads);
+		}
+
+		auto const binOf = [&](std::uint32_t const shape) {
+			auto const offset = (component(centroids_[shape], axis) - axisMin) / axisExtent;
+			return std::min(kBins - 1, static_cast<std::size_t>(offset * kBins));
+		};
+		auto const bins = binsOf(shapeBounds, begin, end, binOf, binningThreads);
+
+		// rightCost[split] accumulates the cost of bins [split, kBins).
+		std::array<T, kBins> rightCost{};
+		BasicBoundingBox<T> rightBounds{};
+		std::uint32_t rightCount{};
+		for (auto split = kBins - 1; split > 0; --split) {
+			rightBounds.extend(bins[split].bounds);
+			rightCount += bins[split].count;
+			rightCost[split] = rightCount * rightBounds.surfaceArea();
+		}
+		BasicBoundingBox<T> leftBounds{};
+		std::uint32_t leftCount{};
+		auto bestCost = std::numeric_limits<T>::infinity();
+		std::size_t bestSplit{};
+		for (std::size_t split = 1; split < kBins; ++split) {
+			leftBounds.extend(bins[split - 1].bounds);
+			leftCount += bins[split - 1].count;
+			auto const cost = leftCount * leftBounds.surfaceArea() + rightCost[split];
+			if (leftCount > 0 && leftCount < count && cost < bestCost) {
+				bestCost = cost;
+				bestSplit = split;
+			}
+		}
+
+		auto const area = bounds.surfaceArea();
+		auto const splitCost = kTraversalCost + (area > T(0) ? bestCost / area : T(count));
+		if (count <= kMaximumLeafSize && splitCost >= T(count)) {
+			return makeLeaf(nodes, node, begin, end);
+		}
+		if (bestSplit == 0) {
+			return makeInterior(shapeBounds, nodes, node, begin, splitInMiddle(begin, end, axis), end, axis, depth, threads);
+		}
+		auto const middle = std::partition(shapes_.begin() + begin, shapes_.begin() + end, [&](std::uint32_t const shape) {
+			return binOf(shape) < bestSplit;
+		});
+		makeInterior(shapeBounds, nodes, node, begin, static_cast<std::uint32_t>(middle - shapes_.begin()), end, axis, depth, threads);
+	}
+
+	std::uint32_t splitInMiddle(std::uint32_t const begin, std::uint32_t const end, unsigned const axis) {
+		auto const split = begin + (end - begin) / 2;
+		std::nth_element(shapes_.begin() + begin, shapes_.begin() + split, shapes_.begin() + end, [&](std::uint32_t const lhs, std::uint32_t const rhs) {
+			return component(centroids_[lhs], axis) < component(centroids_[rhs], axis);
+		});
+		return split;
+	}
+};
+
+using Bvh = BasicBvh<double>;
+using BvhF = BasicBvh<float>;
+
+
+#endif /* BVH_H_ */
@@ -0,0 +1,286 @@
+#ifndef BVH4_H_
+#define BVH4_H_
+
+#include "BoundingBox.h"
+#include "Bvh.h"
+#include "Direction.h"
+#include "MatrixKernels.h"
+#include "Point.h"
+#include "Ray.h"
+#include "Span.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+
+// Two cache lines: the bounds of up to four children, stored per axis so
+// one SIMD slab test covers all of them, and the links to the children.
+struct alignas(64) Bvh4Node {
+	static constexpr std::size_t kWidth{4};
+
+	std::array<std::array<float, kWidth>, 3> min;
+	std::array<std::array<float, kWidth>, 3> max;
+	// Interior children: node index. Leaf children: first primitive.
+	std::array<std::uint32_t, kWidth> child;
+	// Number of primitives of a leaf child, 0 for interior children.
+	std::array<std::uint8_t, kWidth> count;
+	std::uint8_t children;
+};
+
+static_assert(sizeof(Bvh4Node) == 128, "Bvh4Node must stay two cache lines");
+
+namespace {
+
+// Slab test of the ray against the children of node, with the same
+// comparisons as intersects(). Returns a bit per child the ray enters
+// within [tMin, tMax] and stores the entry times.
+template <typename T>
+unsigned intersectChildren(Bvh4Node const & node, BasicPrecomputedRay<T> const & ray, T const tMin, T const tMax, std::array<T, Bvh4Node::kWidth> & entries) noexcept {
+	unsigned const valid = (1u << node.children) - 1;
+#ifdef RAYTRACER_X86_KERNELS
+	if constexpr (std::is_same_v<T, float>) {
+		__m128 near = _mm_set1_ps(tMin);
+		__m128 far = _mm_set1_ps(tMax);
+		for (auto axis = 0u; axis < 3; ++axis) {
+			auto const & nearPlanes = ray.sign[axis] ? node.max[axis] : node.min[axis];
+			auto const & farPlanes = ray.sign[axis] ? node.min[axis] : node.max[axis];
+			__m128 const position = _mm_set1_ps(component(ray.origin, axis));
+			__m128 const inverse = _mm_set1_ps(component(ray.inverseDirection, axis));
+			near = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(nearPlanes.data()), position), inverse), near);
+			far = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(farPlanes.data()), position), inverse), far);
+		}
+		_mm_storeu_ps(entries.data(), near);
+		return static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(near, far))) & valid;
+	} else {
+		// Single precision bounds widen exactly, so double rays lose nothing.
+		__m128d near[2]{_mm_set1_pd(tMin), _mm_set1_pd(tMin)};
+		__m128d far[2]{_mm_set1_pd(tMax), _mm_set1_pd(tMax)};
+		for (auto axis = 0u; axis < 3; ++axis) {
+			__m128d const position = _mm_set1_pd(component(ray.origin, axis));
+			__m128d const inverse = _mm_set1_pd(component(ray.inverseDirection, axis));
+			__m128 const nearPlanes = _mm_load_ps((ray.sign[axis] ? node.max[axis] : node.min[axis]).data());
+			__m128 const farPlanes = _mm_load_ps((ray.sign[axis] ? node.min[axis] : node.max[axis]).data());
+			__m128d const nears[2]{_mm_cvtps_pd(nearPlanes), _mm_cvtps_pd(_mm_movehl_ps(nearPlanes, nearPlanes))};
+			__m128d const fars[2]{_mm_cvtps_pd(farPlanes), _mm_cvtps_pd(_mm_movehl_ps(farPlanes, farPlanes))};
+			for (auto half = 0u; half < 2; ++half) {
+				near[half] = _mm_max_pd(_mm_mul_pd(_mm_sub_pd(nears[half], position), inverse), near[half]);
+				far[half] = _mm_min_pd(_mm_mul_pd(_mm_sub_pd(fars[half], position), inverse), far[half]);
+			}
+		}
+		_mm_storeu_pd(entries.data(), near[0]);
+		_mm_storeu_pd(entries.data() + 2, near[1]);
+		auto const mask = _mm_movemask_pd(_mm_cmple_pd(near[0], far[0])) | _mm_movemask_pd(_mm_cmple_pd(near[1], far[1])) << 2;
+		return static_cast<unsigned>(mask) & valid;
+	}
+#else
+	unsigned mask{};
+	for (auto slot = 0u; slot < node.children; ++slot) {
+		BasicBoundingBox<T> const box{
+				{T(node.min[0][slot]), T(node.min[1][slot]), T(node.min[2][slot])},
+				{T(node.max[0][slot]), T(node.max[1][slot]), T(node.max[2][slot])}};
+		if (intersects(box, ray, tMin, tMax, entries[slot])) {
+			mask |= 1u << slot;
+		}
+	}
+	return mask;
+#endif
+}
+
+}
+
+// Four-wide hierarchy collapsed from the binary one: every node adopts
+// grandchildren until it has four children, which roughly halves the
+// depth and replaces pairs of scalar slab tests with one SIMD test.
+template <typename T>
+class BasicBvh4 {
+public:
+	// Each node on the path defers at most three children.
+	static constexpr std::size_t kStackSize{3 * BasicBvh<T>::kMaximumDepth + Bvh4Node::kWidth};
+
+	BasicBvh4() = default;
+
+	explicit BasicBvh4(std::vector<BasicBoundingBox<T>> const & shapeBounds) :
+			BasicBvh4(BasicBvh<T>{shapeBounds}) {
+	}
+
+	explicit BasicBvh4(BasicBvh<T> const & binary) :
+			shapes_(binary.shapes()) {
+		primitiveBounds_.reserve(shapes_.size());
+		for (std::uint32_t primitive = 0; primitive < shapes_.size(); ++primitive) {
+			primitiveBounds_.push_back(binary.primitiveBounds(primitive));
+		}
+		if (binary.nodeCount() != 0) {
+			nodes_.reserve(binary.nodeCount() / 2 + 1);
+			slots_.assign(binary.nodeCount(), kNoSlot);
+			collapse(binary, {0}, 1);
+		}
+	}
+
+	// Follows a binary.refit() that changed the given binary nodes and
+	// primitives; the structure of binary must not have changed since.
+	void refit(BasicBvh<T> const & binary, Span<std::uint32_t const> const binaryNodes, Span<std::uint32_t const> const primitives) {
+		for (auto const primitive : primitives) {
+			primitiveBounds_[primitive] = binary.primitiveBounds(primitive);
+		}
+		for (auto const binaryNode : binaryNodes) {
+			auto const slot = slots_[binaryNode];
+			if (slot == kNoSlot) {
+				continue;
+			}
+			auto & node = nodes_[slot / Bvh4Node::kWidth];
+			auto const & source = binary.nodes()[binaryNode];
+			for (auto axis = 0u; axis < 3; ++axis) {
+				node.min[axis][slot % Bvh4Node::kWidth] = source.min[axis];
+				node.max[axis][slot % Bvh4Node::kWidth] = source.max[axis];
+			}
+		}
+	}
+
+	std::size_t size() const noexcept {
+		return shapes_.size();
+	}
+
+	std::vector<Bvh4Node> const & nodes() const noexcept {
+		return nodes_;
+	}
+
+	std::size_t nodeCount() const noexcept {
+		return nodes_.size();
+	}
+
+	std::vector<std::uint32_t> const & shapes() const noexcept {
+		return shapes_;
+	}
+
+	BasicBoundingBox<T> const & primitiveBounds(std::uint32_t const primitive) const noexcept {
+		return primitiveBounds_[primitive];
+	}
+
+	// Same contract as BasicBvh::traverse. The children a ray enters are
+	// visited nearest first; nodesVisited counts the wide nodes tested.
+	template <typename Visitor>
+	BvhTraversalCounters traverse(BasicPrecomputedRay<T> const & ray, Visitor && visit) const {
+		BvhTraversalCounters counters{};
+		if (nodes_.empty()) {
+			return counters;
+		}
+		auto const tMin = ray.tMin;
+		auto tMax = ray.tMax;
+		std::array<Entry, kStackSize> stack;
+		std::size_t stackSize{};
+		stack[stackSize++] = {0, 0, tMin};
+		while (stackSize != 0) {
+			auto const top = stack[--stackSize];
+			if (top.entry > tMax) {
+				continue;
+			}
+			if (top.count != 0) {
+				counters.primitivesVisited += top.count;
+				for (auto primitive = top.child; primitive < top.child + top.count; ++primitive) {
+					tMax = visit(primitive, tMax);
+					if (tMax < tMin) {
+						return counters;
+					}
+				}
+				continue;
+			}
+			auto const & node = nodes_[top.child];
+			++counters.nodesVisited;
+			std::array<T, Bvh4Node::kWidth> entries{};
+			auto mask = intersectChildren(node, ray, tMin, tMax, entries);
+			// Pushes the hit children farthest first, so the nearest is popped next.
+			auto const base = stackSize;
+			for (unsigned slot = 0; mask != 0; ++slot, mask >>= 1) {
+				if (mask & 1u) {
+					Entry const child{node.child[slot], node.count[slot], entries[slot]};
+					auto position = stackSize++;
+					for (; position > base && stack[position - 1].entry < child.entry; --position) {
+						stack[position] = stack[position - 1];
+					}
+					stack[position] = child;
+				}
+			}
+		}
+		return counters;
+	}
+
+	template <typename Visitor>
+	BvhTraversalCounters traverse(BasicRay<T> const & ray, T const tMin, T const tMax, Visitor && visit) const {
+		return traverse(BasicPrecomputedRay<T>{ray, tMin, tMax}, visit);
+	}
+
+private:
+	struct Entry {
+		std::uint32_t child;
+		std::uint32_t count;
+		T entry;
+	};
+
+	static constexpr std::uint32_t kNoSlot{std::numeric_limits<std::uint32_t>::max()};
+
+	std::vector<Bvh4Node> nodes_{};
+	std::vector<std::uint32_t> shapes_{};
+	std::vector<BasicBoundingBox<T>> primitiveBounds_{};
+	// For each binary node that became a child, its node * kWidth + slot.
+	std::vector<std::uint32_t> slots_{};
+
+	static T area(BvhNode const & node) noexcept {
+		return node.bounds<T>().surfaceArea();
+	}
+
+	// Emits a node over the given binary nodes after repeatedly opening the
+	// interior one with the largest surface area.
+	std::uint32_t collapse(BasicBvh<T> const & binary, std::array<std::uint32_t, Bvh4Node::kWidth> slots, std::size_t children) {
+		auto const & binaryNodes = binary.nodes();
+		while (children < Bvh4Node::kWidth) {
+			std::size_t largest{Bvh4Node::kWidth};
+			for (std::size_t slot = 0; slot < children; ++slot) {
+				auto const & candidate = binaryNodes[slots[slot]];
+				if (!candidate.leaf() && (largest == Bvh4Node::kWidth || area(candidate) > area(binaryNodes[slots[largest]]))) {
+					largest = slot;
+				}
+			}
+			if (largest == Bvh4Node::kWidth) {
+				break;
+			}
+			auto const opened = slots[largest];
+			slots[largest] = opened + 1;
+			slots[children++] = binaryNodes[opened].offset;
+		}
+
+		auto const index = static_cast<std::uint32_t>(nodes_.size());
+		Bvh4Node node{};
+		for (auto axis = 0u; axis < 3; ++axis) {
+			node.min[axis].fill(std::numeric_limits<float>::infinity());
+			node.max[axis].fill(-std::numeric_limits<float>::infinity());
+		}
+		node.children = static_cast<std::uint8_t>(children);
+		nodes_.push_back(node);
+		for (std::size_t slot = 0; slot < children; ++slot) {
+			auto const & child = binaryNodes[slots[slot]];
+			slots_[slots[slot]] = static_cast<std::uint32_t>(index * Bvh4Node::kWidth + slot);
+			for (auto axis = 0u; axis < 3; ++axis) {
+				nodes_[index].min[axis][slot] = child.min[axis];
+				nodes_[index].max[axis][slot] = child.max[axis];
+			}
+			if (child.leaf()) {
+				nodes_[index].child[slot] = child.offset;
+				nodes_[index].count[slot] = static_cast<std::uint8_t>(child.count);
+			} else {
+				auto const collapsed = collapse(binary, {slots[slot] + 1, child.offset}, 2);
+				nodes_[index].child[slot] = collapsed;
+			}
+		}
+		return index;
+	}
+};
+
+using Bvh4 = BasicBvh4<double>;
+using Bvh4F = BasicBvh4<float>;
+
+
+#endif /* BVH4_H_ */
@@ -6,55 +6,70 @@
 
 #include <ostream>
 
-struct Color: operators::equality_comparable<Color>,
-				operators::addable<Color>,
-				operators::subtractable<Color>,
-				operators::multipliable<Color, double>,
-				operators::multipliable<Color> {
-	double red{};
-	double green{};
-	double blue{};
-
-	constexpr Color() = default;
-	constexpr Color(double const red, double const green, double const blue) :
+template <typename T>
+struct BasicColor: operators::equality_comparable<BasicColor<T>>,
+				operators::addable<BasicColor<T>>,
+				operators::subtractable<BasicColor<T>>,
+				operators::multipliable<BasicColor<T>, T>,
+				operators::multipliable<BasicColor<T>> {
+	T red{};
+	T green{};
+	T blue{};
+
+	constexpr BasicColor() = default;
+	constexpr BasicColor(T const red, T const green, T const blue) :
 			red { red }, green { green }, blue { blue } {
 	}
 
-	constexpr bool operator==(Color const & other) const noexcept {
+	template <typename U>
+	constexpr explicit BasicColor(BasicColor<U> const & other) :
+			red { static_cast<T>(other.red) }, green { static_cast<T>(other.green) }, blue { static_cast<T>(other.blue) } {
+	}
+
+	constexpr bool operator==(BasicColor const & other) const noexcept {
 		return isEqual(red, other.red) && isEqual(green, other.green) && isEqual(blue, other.blue);
 	}
 };
 
-constexpr inline Color operator-(Color const & color) noexcept {
+using Color = BasicColor<double>;
+using ColorF = BasicColor<float>;
+
+template <typename T>
+constexpr BasicColor<T> operator-(BasicColor<T> const & color) noexcept {
 	return {-color.red, -color.green, -color.blue};
 }
 
-constexpr inline Color & operator+=(Color & lhs, Color const & rhs) noexcept {
+template <typename T>
+constexpr BasicColor<T> & operator+=(BasicColor<T> & lhs, BasicColor<T> const & rhs) noexcept {
 	lhs.red += rhs.red;
 	lhs.green += rhs.green;
 	lhs.blue += rhs.blue;
 	return lhs;
 }
 
-constexpr inline Color & operator-=(Color & lhs, Color const & rhs) noexcept {
+template <typename T>
+constexpr BasicColor<T> & operator-=(BasicColor<T> & lhs, BasicColor<T> const & rhs) noexcept {
 	return lhs += -rhs;
 }
 
-constexpr inline Color & operator*=(Color & lhs, double const factor) noexcept {
+template <typename T>
+constexpr BasicColor<T> & operator*=(BasicColor<T> & lhs, T const factor) noexcept {
 	lhs.red *= factor;
 	lhs.green *= factor;
 	lhs.blue *= factor;
 	return lhs;
 }
 
-constexpr inline Color & operator*=(Color & lhs, Color const & rhs) noexcept {
+template <typename T>
+constexpr BasicColor<T> & operator*=(BasicColor<T> & lhs, BasicColor<T> const & rhs) noexcept {
 	lhs.red *= rhs.red;
 	lhs.green *= rhs.green;
 	lhs.blue *= rhs.blue;
 	return lhs;
 }
 
-inline std::ostream & operator<<(std::ostream & out, Color const & color) {
+template <typename T>
+std::ostream & operator<<(std::ostream & out, BasicColor<T> const & color) {
 	out.precision(8);
 	return out << "Color(" << color.red << ", " << color.green << ", " << color.blue << ")";
 }
@@ -5,15 +5,15 @@
 #include <boost/operators.hpp>
 #include <ostream>
 
-template <typename SubType>
+template <typename SubType, typename T>
 struct Coordinate : private boost::equality_comparable<SubType> {
-	double x{};
-	double y{};
-	double z{};
+	T x{};
+	T y{};
+	T z{};
 
 	constexpr Coordinate() = default;
 
-	constexpr Coordinate(double const x, double const y, double const z) noexcept :
+	constexpr Coordinate(T const x, T const y, T const z) noexcept :
 			x { x }, y { y }, z { z } {
 	}
 
@@ -23,8 +23,8 @@ struct Coordinate : private boost::equality_comparable<SubType> {
 
 };
 
-template <typename Sub>
-std::ostream & operator<<(std::ostream & out, Coordinate<Sub> const & coordinate) {
+template <typename Sub, typename T>
+std::ostream & operator<<(std::ostream & out, Coordinate<Sub, T> const & coordinate) {
 	return out << "(" << coordinate.x << ", " << coordinate.y << ", " << coordinate.z << ")";
 }
 
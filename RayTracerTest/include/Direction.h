@@ -9,59 +9,73 @@
 
 
 
-struct Direction : Coordinate<Direction>, operators::addable<Direction>, operators::subtractable<Direction>, operators::multipliable<Direction, double>, operators::dividable<Direction, double> {
-	using Coordinate<Direction>::Coordinate;
+template <typename T>
+struct BasicDirection : Coordinate<BasicDirection<T>, T>, operators::addable<BasicDirection<T>>, operators::subtractable<BasicDirection<T>>, operators::multipliable<BasicDirection<T>, T>, operators::dividable<BasicDirection<T>, T> {
+	using Coordinate<BasicDirection<T>, T>::Coordinate;
 };
 
-constexpr inline Direction & operator+=(Direction & lhs, Direction const & rhs) noexcept {
+using Direction = BasicDirection<double>;
+using DirectionF = BasicDirection<float>;
+
+template <typename T>
+constexpr BasicDirection<T> & operator+=(BasicDirection<T> & lhs, BasicDirection<T> const & rhs) noexcept {
 	lhs.x += rhs.x;
 	lhs.y += rhs.y;
 	lhs.z += rhs.z;
 	return lhs;
 }
 
-constexpr inline Direction operator-(Direction const & direction) noexcept {
+template <typename T>
+constexpr BasicDirection<T> operator-(BasicDirection<T> const & direction) noexcept {
 	return {-direction.x, -direction.y, -direction.z};
 }
 
-constexpr inline Direction & operator-=(Direction & lhs, Direction const & rhs) noexcept {
+template <typename T>
+constexpr BasicDirection<T> & operator-=(BasicDirection<T> & lhs, BasicDirection<T> const & rhs) noexcept {
 	return lhs += -rhs;
 }
 
-constexpr inline Direction & operator*=(Direction & lhs, double const factor) noexcept {
+template <typename T>
+constexpr BasicDirection<T> & operator*=(BasicDirection<T> & lhs, T const factor) noexcept {
 	lhs.x *= factor;
 	lhs.y *= factor;
 	lhs.z *= factor;
 	return lhs;
 }
 
-constexpr inline Direction & operator/=(Direction & lhs, double const factor) noexcept {
+template <typename T>
+constexpr BasicDirection<T> & operator/=(BasicDirection<T> & lhs, T const factor) noexcept {
 	return lhs *= (1 / factor);
 }
 
 
-constexpr inline double magnitude(Direction const & direction) noexcept {
+template <typename T>
+constexpr T magnitude(BasicDirection<T> const & direction) noexcept {
 	return std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
 }
 
-constexpr inline Direction normalize(Direction const & direction) {
+template <typename T = double>
+constexpr BasicDirection<T> normalize(BasicDirection<T> const & direction) {
 	auto const mag = magnitude(direction);
-	if (isEqual(mag, 0.0)) {
+	if (isEqual(mag, T(0))) {
 		throw std::invalid_argument{"Cannot normalize direction with magnitude 0.0."};
 	}
 	return {direction.x / mag, direction.y / mag, direction.z / mag};
 }
 
-constexpr inline double dot(Direction const & lhs, Direction const & rhs) noexcept {
+template <typename T>
+constexpr T dot(BasicDirection<T> const & lhs, BasicDirection<T> const & rhs) noexcept {
 	return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
 }
 
-constexpr inline Direction cross(Direction const & lhs, Direction const & rhs) noexcept {
+template <typename T>
+constexpr BasicDirection<T> cross(BasicDirection<T> const & lhs, BasicDirection<T> const & rhs) noexcept {
 	return {lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x};
 }
 
-inline std::ostream & operator<<(std::ostream & out, Direction const & direction) {
-	return out << "Direction" << static_cast<Coordinate<Direction> const>(direction);
+template <typename T>
+std::ostream & operator<<(std::ostream & out, BasicDirection<T> const & direction) {
+	return out << "Direction" << static_cast<Coordinate<BasicDirection<T>, T> const>(direction);
 }
 
 
@@ -4,10 +4,14 @@
 
 #include <cmath>
 #include <cstddef>
+#include <type_traits>
 
 template <typename T, typename = std::enable_if<std::is_floating_point_v<T>>>
 constexpr T epsilon = 0.000001;
 
+template <>
+constexpr float epsilon<float> = 0.0001f;
+
 template <typename T, typename = std::enable_if<std::is_floating_point_v<T>>>
 constexpr inline bool isEqual(T const lhs, T const rhs) noexcept {
 	return std::abs(lhs - rhs) < epsilon<T>;
@@ -0,0 +1,240 @@
+#ifndef GRID_H_
+#define GRID_H_
+
+#include "BoundingBox.h"
+#include "Bvh.h"
+#include "Direction.h"
+#include "Point.h"
+#include "Ray.h"
+#include "Span.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+
+// Remembers which shapes a grid traversal has already visited, since a
+// shape is listed in every cell it overlaps. Each traversal gets a new
+// stamp, so starting one does not clear the stamps of the previous one.
+class ShapeMailbox {
+	std::vector<std::uint32_t> stamps_{};
+	std::uint32_t query_{};
+
+public:
+	// Starts a traversal over shapes with ids below shapes.
+	void next(std::size_t const shapes) {
+		if (stamps_.size() < shapes) {
+			stamps_.resize(shapes);
+		}
+		if (++query_ == 0) {
+			std::fill(stamps_.begin(), stamps_.end(), 0u);
+			query_ = 1;
+		}
+	}
+
+	// Whether shape is visited for the first time in the current traversal.
+	bool visit(std::uint32_t const shape) noexcept {
+		auto & stamp = stamps_[shape];
+		if (stamp == query_) {
+			return false;
+		}
+		stamp = query_;
+		return true;
+	}
+};
+
+// Uniform grid over shape bounds, traversed cell by cell with a 3D DDA.
+// Cheap to build and fast for many shapes of similar size; a shape is
+// listed in every cell its bounds overlap.
+template <typename T>
+class BasicGrid {
+public:
+	// Target number of cells per shape when choosing the resolution.
+	static constexpr T kCellsPerShape{T(2)};
+	static constexpr std::size_t kMaximumResolution{512};
+
+	BasicGrid() = default;
+
+	explicit BasicGrid(std::vector<BasicBoundingBox<T>> const & shapeBounds) :
+			shapes_(shapeBounds.size()) {
+		for (auto const & box : shapeBounds) {
+			bounds_.extend(box);
+		}
+		if (bounds_.empty()) {
+			return;
+		}
+		chooseResolution();
+		std::vector<std::uint32_t> counts(cellCount() + 1);
+		forEachCell(shapeBounds, [&](std::uint32_t, std::size_t const cell) {
+			++counts[cell + 1];
+		});
+		std::partial_sum(counts.begin(), counts.end(), counts.begin());
+		cellStart_ = counts;
+		cellShapes_.resize(cellStart_.back());
+		forEachCell(shapeBounds, [&](std::uint32_t const shape, std::size_t const cell) {
+			cellShapes_[counts[cell]++] = shape;
+		});
+	}
+
+	std::size_t size() const noexcept {
+		return shapes_;
+	}
+
+	BasicBoundingBox<T> const & bounds() const noexcept {
+		return bounds_;
+	}
+
+	std::array<std::size_t, 3> const & resolution() const noexcept {
+		return resolution_;
+	}
+
+	std::size_t cellCount() const noexcept {
+		return resolution_[0] * resolution_[1] * resolution_[2];
+	}
+
+	Span<std::uint32_t const> cell(std::size_t const x, std::size_t const y, std::size_t const z) const noexcept {
+		auto const index = cellIndex({x, y, z});
+		return {cellShapes_.data() + cellStart_[index], cellStart_[index + 1] - cellStart_[index]};
+	}
+
+	// Calls visit(shape, tMax) for the shapes of every cell the ray passes
+	// within [ray.tMin, ray.tMax], front to back. visit returns the new
+	// tMax, or a value below tMin to end the traversal. A shape spanning
+	// several cells is visited once per cell. nodesVisited counts the cells.
+	template <typename Visitor>
+	BvhTraversalCounters traverse(BasicPrecomputedRay<T> const & ray, Visitor && visit) const {
+		BvhTraversalCounters counters{};
+		if (cellStart_.empty()) {
+			return counters;
+		}
+		auto const & direction = ray.direction;
+		auto const tMin = ray.tMin;
+		auto tMax = ray.tMax;
+		T entry{};
+		if (!intersects(bounds_, ray, tMin, tMax, entry)) {
+			return counters;
+		}
+		std::array<std::size_t, 3> cell{};
+		std::array<std::ptrdiff_t, 3> step{};
+		std::array<T, 3> next{};
+		std::array<T, 3> delta{};
+		for (auto axis = 0u; axis < 3; ++axis) {
+			auto const origin = component(ray.origin, axis);
+			auto const inverse = component(ray.inverseDirection, axis);
+			auto const minimum = component(bounds_.min, axis);
+			auto const position = origin + component(direction, axis) * entry;
+			cell[axis] = cellOf(position, axis);
+			if (component(direction, axis) == T(0)) {
+				next[axis] = std::numeric_limits<T>::infinity();
+				delta[axis] = std::numeric_limits<T>::infinity();
+			} else if (ray.sign[axis]) {
+				step[axis] = -1;
+				next[axis] = (minimum + cell[axis] * cellSize_[axis] - origin) * inverse;
+				delta[axis] = -cellSize_[axis] * inverse;
+			} else {
+				step[axis] = 1;
+				next[axis] = (minimum + (cell[axis] + 1) * cellSize_[axis] - origin) * inverse;
+				delta[axis] = cellSize_[axis] * inverse;
+			}
+		}
+		while (true) {
+			auto const index = cellIndex(cell);
+			++counters.nodesVisited;
+			counters.primitivesVisited += cellStart_[index + 1] - cellStart_[index];
+			for (auto shape = cellStart_[index]; shape < cellStart_[index + 1]; ++shape) {
+				tMax = visit(cellShapes_[shape], tMax);
+				if (tMax < tMin) {
+					return counters;
+				}
+			}
+			unsigned const axis = next[0] < next[1] ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2);
+			if (next[axis] > tMax) {
+				return counters;
+			}
+			auto const moved = static_cast<std::ptrdiff_t>(cell[axis]) + step[axis];
+			if (moved < 0 || moved >= static_cast<std::ptrdiff_t>(resolution_[axis])) {
+				return counters;
+			}
+			cell[axis] = static_cast<std::size_t>(moved);
+			next[axis] += delta[axis];
+		}
+	}
+
+	template <typename Visitor>
+	BvhTraversalCounters traverse(BasicRay<T> const & ray, T const tMin, T const tMax, Visitor && visit) const {
+		return traverse(BasicPrecomputedRay<T>{ray, tMin, tMax}, visit);
+	}
+
+private:
+	std::size_t shapes_{};
+	BasicBoundingBox<T> bounds_{};
+	std::array<std::size_t, 3> resolution_{};
+	std::array<T, 3> cellSize_{};
+	// The shapes of cell i are cellShapes_[cellStart_[i], cellStart_[i + 1]).
+	std::vector<std::uint32_t> cellStart_{};
+	std::vector<std::uint32_t> cellShapes_{};
+
+	// Roughly cubic cells, about kCellsPerShape of them per shape. Flat scenes are
+	// treated as one cell thick so the volume stays meaningful.
+	void chooseResolution() {
+		auto const extent = bounds_.extent();
+		auto const largest = std::max({extent.x, extent.y, extent.z});
+		auto const floor = largest / T(kMaximumResolution);
+		std::array<T, 3> sides{std::max(extent.x, floor), std::max(extent.y, floor), std::max(extent.z, floor)};
+		if (largest <= T(0)) {
+			sides = {T(1), T(1), T(1)};
+		}
+		auto const cellsPerLength = std::cbrt(kCellsPerShape * T(shapes_) / (sides[0] * sides[1] * sides[2]));
+		for (auto axis = 0u; axis < 3; ++axis) {
+			auto const cells = std::floor(sides[axis] * cellsPerLength);
+			resolution_[axis] = static_cast<std::size_t>(std::clamp(cells, T(1), T(kMaximumResolution)));
+			cellSize_[axis] = sides[axis] / T(resolution_[axis]);
+		}
+	}
+
+	std::size_t cellOf(T const position, unsigned const axis) const noexcept {
+		auto const offset = (position - component(bounds_.min, axis)) / cellSize_[axis];
+		if (!(offset > T(0))) {
+			return 0;
+		}
+		return std::min(resolution_[axis] - 1, static_cast<std::size_t>(offset));
+	}
+
+	std::size_t cellIndex(std::array<std::size_t, 3> const & cell) const noexcept {
+		return (cell[2] * resolution_[1] + cell[1]) * resolution_[0] + cell[0];
+	}
+
+	template <typename Callback>
+	void forEachCell(std::vector<BasicBoundingBox<T>> const & shapeBounds, Callback && callback) const {
+		for (std::uint32_t shape = 0; shape < shapeBounds.size(); ++shape) {
+			auto const & box = shapeBounds[shape];
+			if (box.empty()) {
+				continue;
+			}
+			std::array<std::size_t, 3> low{};
+			std::array<std::size_t, 3> high{};
+			for (auto axis = 0u; axis < 3; ++axis) {
+				low[axis] = cellOf(component(box.min, axis), axis);
+				high[axis] = cellOf(component(box.max, axis), axis);
+			}
+			for (auto z = low[2]; z <= high[2]; ++z) {
+				for (auto y = low[1]; y <= high[1]; ++y) {
+					for (auto x = low[0]; x <= high[0]; ++x) {
+						callback(shape, cellIndex({x, y, z}));
+					}
+				}
+			}
+		}
+	}
+};
+
+using Grid = BasicGrid<double>;
+using GridF = BasicGrid<float>;
+
+
+#endif /* GRID_H_ */
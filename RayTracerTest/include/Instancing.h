@@ -0,0 +1,305 @@
+#ifndef INSTANCING_H_
+#define INSTANCING_H_
+
+#include "BoundingBox.h"
+#include "Bvh.h"
+#include "Direction.h"
+#include "Intersections.h"
+#include "Material.h"
+#include "Occlusion.h"
+#include "Operators.h"
+#include "Point.h"
+#include "Ray.h"
+#include "Sphere.h"
+#include "Transform.h"
+#include "ValueType.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+// Handles of the geometries and instances stored in an InstancedScene.
+struct GeometryId : ValueType<std::uint32_t, GeometryId>, Comparable<GeometryId>, Printable<GeometryId> {};
+struct InstanceId : ValueType<std::uint32_t, InstanceId>, Comparable<InstanceId>, Printable<InstanceId> {};
+
+// Spheres shared by all instances of a geometry, in the geometry's own
+// space, together with the hierarchy over them. Built once, however many
+// times the geometry is instanced.
+template <typename T>
+class BasicGeometry {
+	// In the leaf order of bvh_; bvh_.shapes() maps them back to ShapeIds
+	// and primitives_ maps ShapeIds to them.
+	std::vector<Shapes::BasicSphere<T>> spheres_{};
+	std::vector<std::uint32_t> primitives_{};
+	BasicBvh<T> bvh_{};
+	BasicBoundingBox<T> bounds_{};
+
+public:
+	explicit BasicGeometry(std::vector<Shapes::BasicSphere<T>> const & spheres) {
+		if (spheres.empty()) {
+			throw std::invalid_argument{"Geometry needs at least one shape"};
+		}
+		std::vector<BasicBoundingBox<T>> shapeBounds{};
+		shapeBounds.reserve(spheres.size());
+		for (auto const & sphere : spheres) {
+			shapeBounds.push_back(Shapes::bounds(sphere));
+			bounds_.extend(shapeBounds.back());
+		}
+		bvh_ = BasicBvh<T>{shapeBounds};
+		spheres_.reserve(spheres.size());
+		primitives_.resize(spheres.size());
+		for (std::uint32_t primitive = 0; primitive < spheres.size(); ++primitive) {
+			auto const shape = bvh_.shapes()[primitive];
+			spheres_.push_back(spheres[shape]);
+			primitives_[shape] = primitive;
+		}
+	}
+
+	std::size_t size() const noexcept {
+		return spheres_.size();
+	}
+
+	BasicBoundingBox<T> const & bounds() const noexcept {
+		return bounds_;
+	}
+
+	BasicBvh<T> const & bvh() const noexcept {
+		return bvh_;
+	}
+
+	Shapes::BasicSphere<T> const & operator[](ShapeId const id) const {
+		if (id.value >= spheres_.size()) {
+			throw std::invalid_argument{"Invalid shape id"};
+		}
+		return spheres_[primitives_[id.value]];
+	}
+
+	// Calls visit(sphere, id, bounds, tMax) for the spheres the hierarchy
+	// cannot rule out, with ray in the space of the geometry, under the
+	// contract of BasicBvh::traverse.
+	template <typename Visitor>
+	BvhTraversalCounters traverse(BasicPrecomputedRay<T> const & ray, Visitor && visit) const {
+		return bvh_.traverse(ray, [&](std::uint32_t const primitive, T const tMax) {
+			return visit(spheres_[primitive], ShapeId{bvh_.shapes()[primitive]}, bvh_.primitiveBounds(primitive), tMax);
+		});
+	}
+};
+
+using Geometry = BasicGeometry<double>;
+using GeometryF = BasicGeometry<float>;
+
+// A placement of a geometry: its transform to world space and, optionally,
+// a material replacing those of the geometry's spheres.
+template <typename T>
+struct BasicInstance {
+	GeometryId geometry{};
+	BasicTransform<T> transform{};
+	std::optional<BasicMaterial<T>> material{};
+};
+
+using Instance = BasicInstance<double>;
+using InstanceF = BasicInstance<float>;
+
+template <typename T>
+struct BasicInstanceIntersection : operators::equality_comparable<BasicInstanceIntersection<T>> {
+	T time{};
+	InstanceId instance{};
+	ShapeId shape{};
+
+	constexpr BasicInstanceIntersection() = default;
+	constexpr BasicInstanceIntersection(T const time, InstanceId const instance, ShapeId const shape) :
+			time{time}, instance{instance}, shape{shape}{}
+
+	constexpr bool operator==(BasicInstanceIntersection const & other) const {
+		return time == other.time && instance == other.instance && shape == other.shape;
+	}
+};
+
+using InstanceIntersection = BasicInstanceIntersection<double>;
+using InstanceIntersectionF = BasicInstanceIntersection<float>;
+
+// Geometries and the instances placing them. Memory grows with the unique
+// geometry plus one transform per instance. Queries find the instances a
+// ray may hit through a top level hierarchy over their world bounds, once
+// buildBvh() was called, and then traverse the geometry's own hierarchy
+// with the ray taken to the instance's space. The transformed direction is
+// not renormalized, so times along it equal the times along the world ray.
+template <typename T>
+class BasicInstancedScene {
+	std::vector<BasicGeometry<T>> geometries_{};
+	std::vector<BasicInstance<T>> instances_{};
+	// World space bounds of each instance.
+	std::vector<BasicBoundingBox<T>> bounds_{};
+	BasicBvh<T> bvh_{};
+
+	// Calls visit(instance, id, tMax) for the instances the top level cannot
+	// rule out, under the contract of BasicBvh::traverse.
+	template <typename Visitor>
+	BvhTraversalCounters forEachInstance(BasicPrecomputedRay<T> const & ray, Visitor && visit) const {
+		auto const visitInstance = [&](std::uint32_t const instance, T const tMax) {
+			T entry{};
+			if (!intersects(bounds_[instance], ray, ray.tMin, tMax, entry)) {
+				return tMax;
+			}
+			return visit(instances_[instance], InstanceId{instance}, tMax);
+		};
+		if (hasBvh()) {
+			return bvh_.traverse(ray, [&](std::uint32_t const primitive, T const tMax) {
+				return visitInstance(bvh_.shapes()[primitive], tMax);
+			});
+		}
+		BvhTraversalCounters counters{};
+		auto tMax = ray.tMax;
+		for (std::uint32_t instance = 0; instance < instances_.size() && tMax >= ray.tMin; ++instance) {
+			++counters.primitivesVisited;
+			tMax = visitInstance(instance, tMax);
+		}
+		return counters;
+	}
+
+	BasicInstance<T> const & instance(InstanceId const id) const {
+		if (id.value >= instances_.size()) {
+			throw std::invalid_argument{"Invalid instance id"};
+		}
+		return instances_[id.value];
+	}
+
+public:
+	GeometryId add(BasicGeometry<T> geometry) {
+		if (geometries_.size() > std::numeric_limits<std::uint32_t>::max()) {
+			throw std::invalid_argument{"Scene cannot hold more geometries"};
+		}
+		geometries_.push_back(std::move(geometry));
+		return GeometryId{static_cast<std::uint32_t>(geometries_.size() - 1)};
+	}
+
+	// Adding an instance discards the top level hierarchy until it is built again.
+	InstanceId add(BasicInstance<T> const & instance) {
+		if (instance.geometry.value >= geometries_.size()) {
+			throw std::invalid_argument{"Invalid geometry id"};
+		}
+		if (instances_.size() > std::numeric_limits<std::uint32_t>::max()) {
+			throw std::invalid_argument{"Scene cannot hold more instances"};
+		}
+		bvh_ = {};
+		instances_.push_back(instance);
+		bounds_.push_back(transformed(instance.transform.matrix(), geometries_[instance.geometry.value].bounds()));
+		return InstanceId{static_cast<std::uint32_t>(instances_.size() - 1)};
+	}
+
+	std::vector<BasicGeometry<T>> const & geometries() const noexcept {
+		return geometries_;
+	}
+
+	std::vector<BasicInstance<T>> const & instances() const noexcept {
+		return instances_;
+	}
+
+	BasicBoundingBox<T> const & bounds(InstanceId const id) const noexcept {
+		return bounds_[id.value];
+	}
+
+	// Builds the top level hierarchy over the instances with up to threads
+	// threads. Each geometry built its own hierarchy when it was created.
+	BasicBvhBuildStatistics<T> buildBvh(std::size_t const threads = 1) {
+		bvh_ = BasicBvh<T>{bounds_, threads};
+		return bvh_.statistics();
+	}
+
+	bool hasBvh() const noexcept {
+		return bvh_.size() != 0 && bvh_.size() == instances_.size();
+	}
+
+	BasicBvh<T> const & bvh() const noexcept {
+		return bvh_;
+	}
+
+	Shapes::BasicSphere<T> const & sphere(BasicInstanceIntersection<T> const & intersection) const {
+		return geometries_[instance(intersection.instance).geometry.value][intersection.shape];
+	}
+
+	// The instance's material if it overrides the geometry's, otherwise the sphere's.
+	BasicMaterial<T> material(BasicInstanceIntersection<T> const & intersection) const {
+		auto const & placed = instance(intersection.instance);
+		return placed.material ? *placed.material : sphere(intersection).material;
+	}
+
+	// World space normal at a world space point on the intersected sphere.
+	BasicDirection<T> normalAt(BasicInstanceIntersection<T> const & intersection, BasicPoint<T> const & point) const {
+		auto const & transform = instance(intersection.instance).transform;
+		auto const objectNormal = ::Shapes::normalAt(sphere(intersection), transform.inverse() * point);
+		return normalize(transform.inverseTranspose() * objectNormal);
+	}
+
+	// Nearest intersection at a non-negative time. counters accumulates the
+	// nodes and primitives visited at both levels.
+	std::optional<BasicInstanceIntersection<T>> hit(BasicRay<T> const & ray, BvhTraversalCounters & counters) const {
+		std::optional<BasicInstanceIntersection<T>> closest{};
+		BasicPrecomputedRay<T> const precomputed{ray};
+		counters += forEachInstance(precomputed, [&](BasicInstance<T> const & placed, InstanceId const id, T const tMax) {
+			auto localRay = precomputed.toObjectSpace(placed.transform);
+			localRay.tMax = tMax;
+			auto nearest = tMax;
+			counters += geometries_[placed.geometry.value].traverse(localRay, [&](Shapes::BasicSphere<T> const & sphere, ShapeId const shape, BasicBoundingBox<T> const & bounds, T const tMax) {
+				T entry{};
+				if (!intersects(bounds, localRay, T(0), tMax, entry)) {
+					return tMax;
+				}
+				auto const time = hitTime(sphere, localRay, tMax);
+				if (!time) {
+					return tMax;
+				}
+				closest = BasicInstanceIntersection<T>{*time, id, shape};
+				nearest = *time;
+				return *time;
+			});
+			return nearest;
+		});
+		return closest;
+	}
+
+	std::optional<BasicInstanceIntersection<T>> hit(BasicRay<T> const & ray) const {
+		BvhTraversalCounters counters{};
+		return hit(ray, counters);
+	}
+
+	// Whether ray hits any instance at a time in [0, maxTime); stops at the
+	// first such hit rather than looking for the nearest.
+	bool anyHit(BasicRay<T> const & ray, T const maxTime, BvhTraversalCounters & counters) const {
+		auto found = false;
+		BasicPrecomputedRay<T> const precomputed{ray, T(0), maxTime};
+		counters += forEachInstance(precomputed, [&](BasicInstance<T> const & placed, InstanceId, T const tMax) {
+			auto localRay = precomputed.toObjectSpace(placed.transform);
+			localRay.tMax = tMax;
+			counters += geometries_[placed.geometry.value].traverse(localRay, [&](Shapes::BasicSphere<T> const & sphere, ShapeId, BasicBoundingBox<T> const & bounds, T const tMax) {
+				T entry{};
+				if (!intersects(bounds, localRay, T(0), tMax, entry)) {
+					return tMax;
+				}
+				if (blocks(sphere, localRay, maxTime)) {
+					found = true;
+					return -std::numeric_limits<T>::infinity();
+				}
+				return tMax;
+			});
+			return found ? -std::numeric_limits<T>::infinity() : tMax;
+		});
+		return found;
+	}
+
+	bool anyHit(BasicRay<T> const & ray, T const maxTime = std::numeric_limits<T>::infinity()) const {
+		BvhTraversalCounters counters{};
+		return anyHit(ray, maxTime, counters);
+	}
+};
+
+using InstancedScene = BasicInstancedScene<double>;
+using InstancedSceneF = BasicInstancedScene<float>;
+
+
+#endif /* INSTANCING_H_ */
@@ -3,50 +3,64 @@
 
 #include "Ray.h"
 #include "Sphere.h"
+#include "ValueType.h"
 
 #include <array>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <optional>
 #include <stdexcept>
+#include <vector>
 
-struct Intersection : operators::equality_comparable<Intersection> {
-	double const time{};
-	std::variant<Shapes::Sphere> const object{};
+// Handle of a shape stored in a Scene.
+struct ShapeId : ValueType<std::uint32_t, ShapeId>, Comparable<ShapeId>, Printable<ShapeId> {};
 
-	constexpr Intersection() = default;
-	template <typename Shape>
-	constexpr Intersection(double const time, Shape const & shape) :
-			time{time}, object{shape}{}
+template <typename T>
+struct BasicIntersection : operators::equality_comparable<BasicIntersection<T>> {
+	T time{};
+	ShapeId shape{};
 
-	constexpr bool operator==(Intersection const & other) const {
-		return time == other.time && object == other.object;
+	constexpr BasicIntersection() = default;
+	constexpr BasicIntersection(T const time, ShapeId const shape) :
+			time{time}, shape{shape}{}
+
+	constexpr bool operator==(BasicIntersection const & other) const {
+		return time == other.time && shape == other.shape;
 	}
 };
 
-struct IntersectionResult : operators::equality_comparable<IntersectionResult> {
-	std::array<Intersection, 2> const times{};
+using Intersection = BasicIntersection<double>;
+using IntersectionF = BasicIntersection<float>;
+
+template <typename T>
+struct BasicIntersectionResult : operators::equality_comparable<BasicIntersectionResult<T>> {
+	std::array<BasicIntersection<T>, 2> const times{};
 	std::size_t const count{};
 
-	constexpr IntersectionResult() = default;
-	template <typename Shape>
-	constexpr IntersectionResult(Shape const & shape, double const first, double const second) :
-			times { Intersection{first, shape}, Intersection{second, shape} }, count { 2u } {
+	constexpr BasicIntersectionResult() = default;
+	constexpr BasicIntersectionResult(ShapeId const shape, T const first, T const second) :
+			times { BasicIntersection<T>{first, shape}, BasicIntersection<T>{second, shape} }, count { 2u } {
 	}
 
-	constexpr Intersection operator[](std::size_t const index) const {
+	constexpr BasicIntersection<T> const & operator[](std::size_t const index) const {
 		if (index >= count) {
 			throw std::invalid_argument{"Invalid intersection index"};
 		}
 		return times[index];
 	}
 
-	constexpr bool operator==(IntersectionResult const & other) const {
+	constexpr bool operator==(BasicIntersectionResult const & other) const {
 		return count == other.count && times == other.times;
 	}
 };
 
-constexpr double discriminant(Shapes::Sphere const & sphere, Ray const & ray) {
+using IntersectionResult = BasicIntersectionResult<double>;
+using IntersectionResultF = BasicIntersectionResult<float>;
+
+template <typename T>
+constexpr T discriminant(Shapes::BasicSphere<T> const & sphere, BasicRay<T> const & ray) {
 	auto const sphereToRay = ray.origin - sphere.position;
 	auto const a = dot(ray.direction, ray.direction);
 	auto const b = 2 * dot(ray.direction, sphereToRay);
@@ -54,41 +68,112 @@ constexpr double discriminant(Shapes::Sphere const & sphere, Ray const & ray) {
 	return b * b - 4 * a * c;
 }
 
-template <typename Shape>
-constexpr IntersectionResult intersect(Shape const & shape, Ray const & ray) {
-	auto const transformedRay = ray.transform(inverse(shape.transform));
-	auto const shapeToRay = transformedRay.origin - shape.position;
-	auto const a = dot(transformedRay.direction, transformedRay.direction);
-	auto const b = 2 * dot(transformedRay.direction, shapeToRay);
-	auto const c = dot(shapeToRay, shapeToRay) - 1;
-	auto const discriminant = b * b - 4 * a * c;
-	if (discriminant < 0.0) {
+// The times at which a ray meets a sphere are the roots of
+// a t^2 + 2 halfB t + c = 0.
+template <typename T>
+struct BasicSphereQuadratic {
+	T a;
+	T halfB;
+	T c;
+	T radiusSquared;
+	BasicDirection<T> perpendicular;
+};
+
+template <typename T>
+constexpr BasicSphereQuadratic<T> sphereQuadratic(BasicPoint<T> const & center, T const radius, BasicRay<T> const & ray) {
+	auto const & direction = ray.direction;
+	auto const centerToRay = ray.origin - center;
+	auto const a = dot(direction, direction);
+	auto const halfB = dot(direction, centerToRay);
+	auto const radiusSquared = radius * radius;
+	// The part of centerToRay perpendicular to the ray.
+	auto const perpendicular = centerToRay - direction * (halfB / a);
+	return {a, halfB, dot(centerToRay, centerToRay) - radiusSquared, radiusSquared, perpendicular};
+}
+
+// A shape under a similarity transform is still a sphere in world space
+// and is intersected there. Otherwise the ray is taken to object space,
+// where the shape is the unit sphere; times are the same in both spaces.
+template <typename T, template <typename> class Shape>
+constexpr BasicSphereQuadratic<T> sphereQuadratic(Shape<T> const & shape, BasicRay<T> const & ray) {
+	if (auto const radius = shape.transform.similarityScale(); radius != T(0)) {
+		return sphereQuadratic(center(shape), radius, ray);
+	}
+	return sphereQuadratic(shape.position, T(1), ray.toObjectSpace(shape.transform));
+}
+
+// Solves the quadratic with a single square root. The discriminant
+// halfB^2 - a c equals a (1 - |perpendicular|^2), which does not cancel two
+// large terms when the sphere is far away. The roots are q / a and c / q
+// for q = -(halfB + sign(halfB) sqrt(discriminant)), so neither is the
+// difference of nearly equal values. Returns false if the ray misses.
+template <typename T>
+constexpr bool solve(BasicSphereQuadratic<T> const & quadratic, T & near, T & far) {
+	auto const discriminant = quadratic.a * (quadratic.radiusSquared - dot(quadratic.perpendicular, quadratic.perpendicular));
+	if (discriminant < T(0)) {
+		return false;
+	}
+	auto const root = std::sqrt(discriminant);
+	auto const q = -(quadratic.halfB + (quadratic.halfB < T(0) ? -root : root));
+	if (q == T(0)) {
+		near = far = T(0);
+		return true;
+	}
+	auto const first = q / quadratic.a;
+	auto const second = quadratic.c / q;
+	near = first < second ? first : second;
+	far = first < second ? second : first;
+	return true;
+}
+
+template <typename T, template <typename> class Shape>
+constexpr BasicIntersectionResult<T> intersect(Shape<T> const & shape, BasicRay<T> const & ray, ShapeId const id = {}) {
+	T near{};
+	T far{};
+	if (!solve(sphereQuadratic(shape, ray), near, far)) {
 		return {};
 	}
-	auto  t1 = (-b - std::sqrt(discriminant)) / (2 * a);
-	auto const t2 = (-b + std::sqrt(discriminant)) / (2 * a);
-	if (t1 > t2) {
-		return {shape, t2, t1};
-	} else {
-		return {shape, t1, t2};
+	return {id, near, far};
+}
+
+// The nearest time in [0, tMax) at which ray hits shape, for queries that
+// ignore intersections behind the ray origin. Returns before taking the
+// square root if the ray starts outside the sphere and points away from it.
+template <typename T, template <typename> class Shape>
+constexpr std::optional<T> hitTime(Shape<T> const & shape, BasicRay<T> const & ray, T const tMax = std::numeric_limits<T>::infinity()) {
+	auto const quadratic = sphereQuadratic(shape, ray);
+	if (quadratic.c > T(0) && quadratic.halfB > T(0)) {
+		return {};
+	}
+	T near{};
+	T far{};
+	if (!solve(quadratic, near, far)) {
+		return {};
+	}
+	if (near >= T(0) && near < tMax) {
+		return near;
+	}
+	if (far >= T(0) && far < tMax) {
+		return far;
 	}
+	return {};
 }
 
 template <typename...Inter>
 using Intersections = std::array<Intersection, sizeof...(Inter)>;
 
-template <typename...Inter>
-constexpr Intersections<Inter...> intersections(Inter const &...inters) {
-	return {inters...};
+template <typename T, typename...Inter>
+constexpr std::array<BasicIntersection<T>, 1 + sizeof...(Inter)> intersections(BasicIntersection<T> const & first, Inter const &...inters) {
+	return {first, inters...};
 }
 
-template <std::size_t N>
-constexpr std::optional<Intersection> hit(std::array<Intersection, N> const & inters, std::size_t count = N) {
+template <typename T, std::size_t N>
+constexpr std::optional<BasicIntersection<T>> hit(std::array<BasicIntersection<T>, N> const & inters, std::size_t count = N) {
 	constexpr auto kNoHitIndex = -1;
 	auto minIndex = kNoHitIndex;
 	for (auto index = 0; index < static_cast<decltype(kNoHitIndex)>(count); ++index) {
 		auto const & current = inters[index];
-		if (current.time >= 0.0) {
+		if (current.time >= T(0)) {
 			if (minIndex == kNoHitIndex || inters[minIndex].time > current.time) {
 				minIndex = index;
 			}
@@ -101,5 +186,23 @@ constexpr std::optional<Intersection> hit(std::array<Intersection, N> const & in
 	}
 }
 
+// Reusable storage for all intersections of a ray, see BasicWorld::intersect.
+template <typename T>
+using BasicIntersectionBuffer = std::vector<BasicIntersection<T>>;
+
+using IntersectionBuffer = BasicIntersectionBuffer<double>;
+using IntersectionBufferF = BasicIntersectionBuffer<float>;
+
+template <typename T>
+std::optional<BasicIntersection<T>> hit(BasicIntersectionBuffer<T> const & inters) {
+	std::optional<BasicIntersection<T>> result{};
+	for (auto const & current : inters) {
+		if (current.time >= T(0) && (!result || result->time > current.time)) {
+			result = current;
+		}
+	}
+	return result;
+}
+
 
 #endif /* INTERSECTIONS_H_ */
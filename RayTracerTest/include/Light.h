@@ -6,44 +6,53 @@
 #include "Point.h"
 #include "Reflection.h"
 
-struct Light {
-	Point position;
-	Color intensity;
+template <typename T>
+struct BasicLight {
+	BasicPoint<T> position;
+	BasicColor<T> intensity;
 };
 
-constexpr Light pointLight(Point const & point, Color const & intensity) {
+using Light = BasicLight<double>;
+using LightF = BasicLight<float>;
+
+template <typename T>
+constexpr BasicLight<T> pointLight(BasicPoint<T> const & point, BasicColor<T> const & intensity) {
 	return {point, intensity};
 }
 
-constexpr Color ambient(Color const & effectiveColor, Material const & material) {
+template <typename T>
+constexpr BasicColor<T> ambient(BasicColor<T> const & effectiveColor, BasicMaterial<T> const & material) {
 	return effectiveColor * material.ambient;
 }
 
-constexpr Color diffuse(Color const & effectiveColor, Material const & material, Light const & light, Point const & position, Direction const & normal) {
+template <typename T>
+constexpr BasicColor<T> diffuse(BasicColor<T> const & effectiveColor, BasicMaterial<T> const & material, BasicLight<T> const & light, BasicPoint<T> const & position, BasicDirection<T> const & normal) {
 	auto const lightDirection = normalize(light.position - position);
 	auto const lightDotNormal = dot(lightDirection, normal);
-	if (lightDotNormal < 0.0) {
-		return Colors::black;
+	if (lightDotNormal < T(0)) {
+		return BasicColor<T>{Colors::black};
 	}
 	return effectiveColor * material.diffuse * lightDotNormal;
 }
 
-constexpr Color specular(Material const & material, Light const & light, Point const & position, Direction const & eye, Direction const & normal) {
+template <typename T>
+constexpr BasicColor<T> specular(BasicMaterial<T> const & material, BasicLight<T> const & light, BasicPoint<T> const & position, BasicDirection<T> const & eye, BasicDirection<T> const & normal) {
 	auto const lightDirection = normalize(light.position - position);
 	auto const lightDotNormal = dot(lightDirection, normal);
-	if (lightDotNormal < 0.0) {
-		return Colors::black;
+	if (lightDotNormal < T(0)) {
+		return BasicColor<T>{Colors::black};
 	}
 	auto const reflectDirection = reflect(-lightDirection, normal);
 	auto const reflectDotEye = dot(reflectDirection, eye);
-	if (reflectDotEye <= 0.0) {
-		return Colors::black;
+	if (reflectDotEye <= T(0)) {
+		return BasicColor<T>{Colors::black};
 	}
-	auto const factor = std::pow(reflectDotEye, material.shininess);
+	T const factor = std::pow(reflectDotEye, material.shininess);
 	return light.intensity * material.specular * factor;
 }
 
-constexpr Color lighting(Material const & material, Light const & light, Point const & position, Direction const & eye, Direction const & normal) {
+template <typename T>
+constexpr BasicColor<T> lighting(BasicMaterial<T> const & material, BasicLight<T> const & light, BasicPoint<T> const & position, BasicDirection<T> const & eye, BasicDirection<T> const & normal) {
 	auto const effectiveColor = material.color * light.intensity;
 	auto const ambientColor = ambient(effectiveColor, material);
 	auto const diffuseColor = diffuse(effectiveColor, material, light, position, normal);
@@ -51,6 +60,15 @@ constexpr Color lighting(Material const & material, Light const & light, Point c
 	return ambientColor + diffuseColor + specularColor;
 }
 
+// A point in shadow receives only the ambient part of the light.
+template <typename T>
+constexpr BasicColor<T> lighting(BasicMaterial<T> const & material, BasicLight<T> const & light, BasicPoint<T> const & position, BasicDirection<T> const & eye, BasicDirection<T> const & normal, bool const inShadow) {
+	if (inShadow) {
+		return ambient(material.color * light.intensity, material);
+	}
+	return lighting(material, light, position, eye, normal);
+}
+
 
 
 #endif /* LIGHT_H_ */
@@ -5,14 +5,15 @@
 #include "DoubleComparison.h"
 #include "Operators.h"
 
-struct Material : operators::equality_comparable<Material> {
-	Color color;
-	double ambient;
-	double diffuse;
-	double specular;
-	double shininess;
-
-	constexpr bool operator==(Material const & other) const {
+template <typename T>
+struct BasicMaterial : operators::equality_comparable<BasicMaterial<T>> {
+	BasicColor<T> color;
+	T ambient;
+	T diffuse;
+	T specular;
+	T shininess;
+
+	constexpr bool operator==(BasicMaterial const & other) const {
 		return color == other.color &&
 				isEqual(ambient, other.ambient) &&
 				isEqual(diffuse, other.diffuse) &&
@@ -21,7 +22,13 @@ struct Material : operators::equality_comparable<Material> {
 	}
 };
 
-constexpr Material defaultMaterial{{}, Colors::white, 0.1, 0.9, 0.9, 200.0};
+using Material = BasicMaterial<double>;
+using MaterialF = BasicMaterial<float>;
+
+template <typename T>
+constexpr BasicMaterial<T> basicDefaultMaterial{{}, BasicColor<T>{Colors::white}, T(0.1), T(0.9), T(0.9), T(200.0)};
+
+constexpr Material defaultMaterial = basicDefaultMaterial<double>;
 
 
 #endif /* MATERIAL_H_ */
@@ -6,15 +6,18 @@
 #include "Direction.h"
 #include "DoubleComparison.h"
 #include "Index.h"
+#include "MatrixKernels.h"
 #include "Point.h"
 
 #include <boost/operators.hpp>
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstddef>
 #include <iomanip>
 #include <ios>
 #include <stdexcept>
+#include <type_traits>
 
 
 struct MatrixIndex {
@@ -29,11 +32,9 @@ constexpr inline MatrixIndex operator,(Row const row, Column const column) noexc
 }
 
 
-template <std::size_t Rows, std::size_t Columns, typename ValueType = double>
-struct Matrix  {
-	std::array<ValueType, Rows * Columns> values{};
-
-	constexpr std::size_t toAbsoluteOffset(MatrixIndex const index) const {
+struct CheckedAccess {
+	template <std::size_t Rows, std::size_t Columns>
+	static constexpr std::size_t offset(MatrixIndex const index) {
 		if (index.row.value >= Rows) {
 			throw std::invalid_argument{"Row access outside of available rows"};
 		}
@@ -42,6 +43,29 @@ struct Matrix  {
 		}
 		return index.row.value * Columns + index.column.value;
 	}
+};
+
+struct UncheckedAccess {
+	template <std::size_t Rows, std::size_t Columns>
+	static constexpr std::size_t offset(MatrixIndex const index) noexcept {
+		return index.row.value * Columns + index.column.value;
+	}
+};
+
+#ifdef NDEBUG
+using DefaultAccess = UncheckedAccess;
+#else
+using DefaultAccess = CheckedAccess;
+#endif
+
+
+template <std::size_t Rows, std::size_t Columns, typename ValueType = double, typename Access = DefaultAccess>
+struct Matrix  {
+	std::array<ValueType, Rows * Columns> values{};
+
+	constexpr std::size_t toAbsoluteOffset(MatrixIndex const index) const {
+		return Access::template offset<Rows, Columns>(index);
+	}
 
 	constexpr ValueType & operator[](MatrixIndex const & index) {
 		return values[toAbsoluteOffset(index)];
@@ -50,10 +74,24 @@ struct Matrix  {
 	constexpr ValueType const & operator[](MatrixIndex const & index) const {
 		return values[toAbsoluteOffset(index)];
 	}
+
+	template <std::size_t RowIndex, std::size_t ColumnIndex>
+	constexpr ValueType & get() noexcept {
+		static_assert(RowIndex < Rows, "Row access outside of available rows");
+		static_assert(ColumnIndex < Columns, "Column access outside of available columns");
+		return std::get<RowIndex * Columns + ColumnIndex>(values);
+	}
+
+	template <std::size_t RowIndex, std::size_t ColumnIndex>
+	constexpr ValueType const & get() const noexcept {
+		static_assert(RowIndex < Rows, "Row access outside of available rows");
+		static_assert(ColumnIndex < Columns, "Column access outside of available columns");
+		return std::get<RowIndex * Columns + ColumnIndex>(values);
+	}
 };
 
-template<std::size_t M, std::size_t N, typename T>
-constexpr bool operator==(Matrix<M, N, T> const & lhs, Matrix<M, N, T> const & rhs) {
+template<std::size_t M, std::size_t N, typename T, typename A>
+constexpr bool operator==(Matrix<M, N, T, A> const & lhs, Matrix<M, N, T, A> const & rhs) {
 	return std::equal(
 			begin(lhs.values), end(lhs.values), 
 			begin(rhs.values), end(rhs.values), 
@@ -66,14 +104,14 @@ constexpr bool operator==(Matrix<M, N, T> const & lhs, Matrix<M, N, T> const & r
 	});
 }
 
-template<std::size_t M, std::size_t N, typename T>
-constexpr bool operator!=(Matrix<M, N, T> const & lhs, Matrix<M, N, T> const & rhs) {
+template<std::size_t M, std::size_t N, typename T, typename A>
+constexpr bool operator!=(Matrix<M, N, T, A> const & lhs, Matrix<M, N, T, A> const & rhs) {
 	return !(lhs == rhs);
 }
 
 
-template<std::size_t M, std::size_t N, typename T>
-std::ostream & operator<<(std::ostream & out, Matrix<M, N, T> const & matrix) {
+template<std::size_t M, std::size_t N, typename T, typename A>
+std::ostream & operator<<(std::ostream & out, Matrix<M, N, T, A> const & matrix) {
 	std::ios_base::fmtflags const flags{out.flags()};
 	out << std::fixed << std::setprecision(6);
 	out << "Matrix<" << M << ", " << N << ">\n";
@@ -91,9 +129,9 @@ std::ostream & operator<<(std::ostream & out, Matrix<M, N, T> const & matrix) {
 	return out;
 }
 
-template<std::size_t M, std::size_t N, std::size_t K, typename T>
-constexpr auto operator*(Matrix<M, N, T> const & lhs, Matrix<N, K, T> const & rhs) {
-	Matrix<M, K, T> result{};
+template<std::size_t M, std::size_t N, std::size_t K, typename T, typename A>
+constexpr auto operator*(Matrix<M, N, T, A> const & lhs, Matrix<N, K, T, A> const & rhs) {
+	Matrix<M, K, T, A> result{};
 	for (auto targetRow = 0_row; targetRow < Row{M}; ++targetRow) {
 		for (auto targetColumn = 0_column; targetColumn < Column{K}; ++targetColumn) {
 			T value{};
@@ -106,8 +144,18 @@ constexpr auto operator*(Matrix<M, N, T> const & lhs, Matrix<N, K, T> const & rh
 	return result;
 }
 
-template<std::size_t M, std::size_t N, typename T>
-constexpr auto operator*=(Matrix<M, N, T> & lhs, T const & factor) {
+template <typename A>
+constexpr Matrix<4, 4, double, A> operator*(Matrix<4, 4, double, A> const & lhs, Matrix<4, 4, double, A> const & rhs) {
+	if (isConstantEvaluated()) {
+		return operator*<4, 4, 4, double, A>(lhs, rhs);
+	}
+	Matrix<4, 4, double, A> result{};
+	kernels::active().multiply(lhs.values.data(), rhs.values.data(), result.values.data());
+	return result;
+}
+
+template<std::size_t M, std::size_t N, typename T, typename A>
+constexpr auto operator*=(Matrix<M, N, T, A> & lhs, T const & factor) {
 	for (auto targetRow = 0_row; targetRow < Row{M}; ++targetRow) {
 		for (auto targetColumn = 0_column; targetColumn < Column{N}; ++targetColumn) {
 			lhs[targetRow, targetColumn] *= factor;
@@ -116,19 +164,19 @@ constexpr auto operator*=(Matrix<M, N, T> & lhs, T const & factor) {
 	return lhs;
 }
 
-template<std::size_t M, std::size_t N, typename T>
-constexpr auto operator*(Matrix<M, N, T> lhs, T const & factor) {
+template<std::size_t M, std::size_t N, typename T, typename A>
+constexpr auto operator*(Matrix<M, N, T, A> lhs, T const & factor) {
 	lhs *= factor;
 	return lhs;
 }
 
-template<std::size_t M, std::size_t N, typename T>
-constexpr auto operator*(T const & factor, Matrix<M, N, T> rhs) {
+template<std::size_t M, std::size_t N, typename T, typename A>
+constexpr auto operator*(T const & factor, Matrix<M, N, T, A> rhs) {
 	return rhs * factor;
 }
 
-template<std::size_t M, std::size_t N, typename T>
-constexpr auto operator/=(Matrix<M, N, T> & lhs, T const & divisor) {
+template<std::size_t M, std::size_t N, typename T, typename A>
+constexpr auto operator/=(Matrix<M, N, T, A> & lhs, T const & divisor) {
 	for (auto targetRow = 0_row; targetRow < Row{M}; ++targetRow) {
 		for (auto targetColumn = 0_column; targetColumn < Column{N}; ++targetColumn) {
 			lhs[targetRow, targetColumn] /= divisor;
@@ -137,25 +185,27 @@ constexpr auto operator/=(Matrix<M, N, T> & lhs, T const & divisor) {
 	return lhs;
 }
 
-template<std::size_t M, std::size_t N, typename T>
-constexpr auto operator/(Matrix<M, N, T> lhs, T const & divisor) {
+template<std::size_t M, std::size_t N, typename T, typename A>
+constexpr auto operator/(Matrix<M, N, T, A> lhs, T const & divisor) {
 	lhs /= divisor;
 	return lhs;
 }
 
-inline constexpr Matrix<4, 1, double> asMatrix(Direction const & direction) {
-	return {direction.x, direction.y, direction.z, 0.0};
+template <typename T>
+constexpr Matrix<4, 1, T> asMatrix(BasicDirection<T> const & direction) {
+	return {direction.x, direction.y, direction.z, T(0)};
 }
 
-inline constexpr Matrix<4, 1, double> asMatrix(Point const & point) {
-	return {point.x, point.y, point.z, 1.0};
+template <typename T>
+constexpr Matrix<4, 1, T> asMatrix(BasicPoint<T> const & point) {
+	return {point.x, point.y, point.z, T(1)};
 }
 
 
 
-template <std::size_t N, std::size_t M, typename T>
-constexpr auto transpose(Matrix<N, M, T> const & matrix) {
-	Matrix<M, N, T> transposed{};
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr auto transpose(Matrix<N, M, T, A> const & matrix) {
+	Matrix<M, N, T, A> transposed{};
 	for (auto sourceRow = 0_row; sourceRow < Row{M}; ++sourceRow) {
 		Column const targetColumn{sourceRow.value};
 		for (auto sourceColumn = 0_column; sourceColumn < Column{N}; ++sourceColumn) {
@@ -167,9 +217,9 @@ constexpr auto transpose(Matrix<N, M, T> const & matrix) {
 }
 
 namespace {
-	template <std::size_t N, typename T = double>
+	template <std::size_t N, typename T, typename A>
 	constexpr auto fillIdentity() {
-		Matrix<N, N, T> result{};
+		Matrix<N, N, T, A> result{};
 		for (auto i = 0u; i < N; ++i) {
 			result[Row{i}, Column{i}] = 1;
 		}
@@ -177,12 +227,12 @@ namespace {
 	}
 }
 
-template <std::size_t N, typename T = double>
-constexpr Matrix<N, N, T> identity = fillIdentity<N, T>();
+template <std::size_t N, typename T = double, typename A = DefaultAccess>
+constexpr Matrix<N, N, T, A> identity = fillIdentity<N, T, A>();
 
-template <std::size_t N, std::size_t M, typename T>
-constexpr auto submatrix(Matrix<N, M, T> const & matrix, Row skippedRow, Column skippedColumn) {
-	Matrix<N - 1, M - 1, T> result{};
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr auto submatrix(Matrix<N, M, T, A> const & matrix, Row skippedRow, Column skippedColumn) {
+	Matrix<N - 1, M - 1, T, A> result{};
 	for (auto targetRow = 0_row; targetRow < Row{N - 1}; ++targetRow) {
 		auto const sourceRow = targetRow < skippedRow ? targetRow : targetRow + 1_row;
 		for (auto targetColumn = 0_column; targetColumn < Column{N - 1}; ++targetColumn) {
@@ -193,46 +243,228 @@ constexpr auto submatrix(Matrix<N, M, T> const & matrix, Row skippedRow, Column
 	return result;
 }
 
-template <std::size_t N, std::size_t M, typename T>
-constexpr T determinant(Matrix<N, M, T> const & matrix);
+template <std::size_t N, typename T, typename A>
+struct LUDecomposition {
+	Matrix<N, N, T, A> lu{};
+	std::array<std::size_t, N> permutation{};
+	T sign{1};
+	bool singular{};
+};
 
-template <typename T>
-constexpr T determinant(Matrix<2, 2, T> const & matrix) {
+template <std::size_t N, typename T, typename A>
+constexpr LUDecomposition<N, T, A> luDecompose(Matrix<N, N, T, A> const & matrix) {
+	LUDecomposition<N, T, A> result{matrix};
+	auto & m = result.lu.values;
+	for (auto row = 0u; row < N; ++row) {
+		result.permutation[row] = row;
+	}
+	for (auto pivot = 0u; pivot < N; ++pivot) {
+		auto pivotRow = pivot;
+		for (auto row = pivot + 1; row < N; ++row) {
+			if (std::abs(m[row * N + pivot]) > std::abs(m[pivotRow * N + pivot])) {
+				pivotRow = row;
+			}
+		}
+		// Only an exact zero stops elimination; whether a small determinant
+		// counts as zero is up to the caller, as for the closed forms.
+		if (m[pivotRow * N + pivot] == T(0)) {
+			result.singular = true;
+			continue;
+		}
+		if (pivotRow != pivot) {
+			for (auto column = 0u; column < N; ++column) {
+				auto const value = m[pivot * N + column];
+				m[pivot * N + column] = m[pivotRow * N + column];
+				m[pivotRow * N + column] = value;
+			}
+			auto const index = result.permutation[pivot];
+			result.permutation[pivot] = result.permutation[pivotRow];
+			result.permutation[pivotRow] = index;
+			result.sign = -result.sign;
+		}
+		for (auto row = pivot + 1; row < N; ++row) {
+			auto const factor = m[row * N + pivot] / m[pivot * N + pivot];
+			m[row * N + pivot] = factor;
+			for (auto column = pivot + 1; column < N; ++column) {
+				m[row * N + column] -= factor * m[pivot * N + column];
+			}
+		}
+	}
+	return result;
+}
+
+template <std::size_t N, typename T, typename A>
+constexpr T determinant(LUDecomposition<N, T, A> const & decomposition) {
+	if (decomposition.singular) {
+		return T(0);
+	}
+	auto result = decomposition.sign;
+	for (auto diagonal = 0u; diagonal < N; ++diagonal) {
+		result *= decomposition.lu.values[diagonal * N + diagonal];
+	}
+	return result;
+}
+
+template <std::size_t N, std::size_t K, typename T, typename A>
+constexpr Matrix<N, K, T, A> solve(LUDecomposition<N, T, A> const & decomposition, Matrix<N, K, T, A> const & rhs) {
+	if (decomposition.singular) {
+		throw std::invalid_argument{"Linear system with singular matrix is not solvable"};
+	}
+	auto const & m = decomposition.lu.values;
+	Matrix<N, K, T, A> result{};
+	auto & x = result.values;
+	for (auto column = 0u; column < K; ++column) {
+		for (auto row = 0u; row < N; ++row) {
+			auto value = rhs.values[decomposition.permutation[row] * K + column];
+			for (auto previous = 0u; previous < row; ++previous) {
+				value -= m[row * N + previous] * x[previous * K + column];
+			}
+			x[row * K + column] = value;
+		}
+		for (auto row = N; row-- > 0;) {
+			auto value = x[row * K + column];
+			for (auto next = row + 1; next < N; ++next) {
+				value -= m[row * N + next] * x[next * K + column];
+			}
+			x[row * K + column] = value / m[row * N + row];
+		}
+	}
+	return result;
+}
+
+template <std::size_t N, typename T, typename A>
+constexpr Matrix<N, N, T, A> inverse(LUDecomposition<N, T, A> const & decomposition) {
+	if (isEqual(determinant(decomposition), T(0))) {
+		throw std::invalid_argument{"Inverse of matrix with determinant zero is not computable"};
+	}
+	return solve(decomposition, identity<N, T, A>);
+}
+
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr T determinant(Matrix<N, M, T, A> const & matrix);
+
+template <typename T, typename A>
+constexpr T determinant(Matrix<2, 2, T, A> const & matrix) {
 	return matrix[0_row, 0_column] * matrix[1_row, 1_column] - matrix[0_row, 1_column] * matrix[1_row, 0_column];
 }
 
 
-template <std::size_t N, std::size_t M, typename T>
-constexpr auto minor(Matrix<N, M, T> const & matrix, Row skippedRow, Column skippedColumn) {
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr auto minor(Matrix<N, M, T, A> const & matrix, Row skippedRow, Column skippedColumn) {
 	auto const sub = submatrix(matrix, skippedRow, skippedColumn);
 	return determinant(sub);
 }
 
-template <std::size_t N, std::size_t M, typename T>
-constexpr T cofactor(Matrix<N, M, T> const & matrix, Row row, Column column) {
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr T cofactor(Matrix<N, M, T, A> const & matrix, Row row, Column column) {
 	auto const resultMinor = minor(matrix, row, column);
 	return (row.value + column.value) % 2 ? -resultMinor : resultMinor;
 }
 
-template <std::size_t N, std::size_t M, typename T>
-constexpr T determinant(Matrix<N, M, T> const & matrix) {
-	T result{};
-	for (auto column = 0_column; column < Column{M}; ++column) {
-		result += matrix[0_row, column] * cofactor(matrix, 0_row, column);
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr T cofactorDeterminant(Matrix<N, M, T, A> const & matrix);
+
+// minor() and cofactor() by cofactor expansion all the way down. Unlike
+// determinant(), they never go through luDecompose(), so
+// cofactorDeterminant() and cofactorInverse() stay independent references
+// for it.
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr T expandedMinor(Matrix<N, M, T, A> const & matrix, Row skippedRow, Column skippedColumn) {
+	return cofactorDeterminant(submatrix(matrix, skippedRow, skippedColumn));
+}
+
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr T expandedCofactor(Matrix<N, M, T, A> const & matrix, Row row, Column column) {
+	auto const resultMinor = expandedMinor(matrix, row, column);
+	return (row.value + column.value) % 2 ? -resultMinor : resultMinor;
+}
+
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr T cofactorDeterminant(Matrix<N, M, T, A> const & matrix) {
+	if constexpr (N <= 2) {
+		return determinant(matrix);
+	} else {
+		T result{};
+		for (auto column = 0_column; column < Column{M}; ++column) {
+			result += matrix[0_row, column] * expandedCofactor(matrix, 0_row, column);
+		}
+		return result;
 	}
-	return result;
 }
 
-template <std::size_t N, std::size_t M, typename T>
-constexpr bool invertible(Matrix<N, M, T> const & matrix) {
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr T determinant(Matrix<N, M, T, A> const & matrix) {
+	static_assert(N == M, "Determinant is only defined for square matrices");
+	if constexpr (std::is_floating_point_v<T>) {
+		return determinant(luDecompose(matrix));
+	} else {
+		return cofactorDeterminant(matrix);
+	}
+}
+
+template <typename T, typename A>
+constexpr T determinant(Matrix<3, 3, T, A> const & matrix) {
+	auto const & m = matrix.values;
+	return m[0] * (m[4] * m[8] - m[5] * m[7])
+			- m[1] * (m[3] * m[8] - m[5] * m[6])
+			+ m[2] * (m[3] * m[7] - m[4] * m[6]);
+}
+
+namespace {
+
+template <typename T>
+struct TwoByTwoMinors {
+	T upper[6];
+	T lower[6];
+};
+
+template <typename T, typename A>
+constexpr TwoByTwoMinors<T> twoByTwoMinors(Matrix<4, 4, T, A> const & matrix) {
+	auto const & m = matrix.values;
+	return {
+		{
+			m[0] * m[5] - m[4] * m[1],
+			m[0] * m[6] - m[4] * m[2],
+			m[0] * m[7] - m[4] * m[3],
+			m[1] * m[6] - m[5] * m[2],
+			m[1] * m[7] - m[5] * m[3],
+			m[2] * m[7] - m[6] * m[3]
+		},
+		{
+			m[8] * m[13] - m[12] * m[9],
+			m[8] * m[14] - m[12] * m[10],
+			m[8] * m[15] - m[12] * m[11],
+			m[9] * m[14] - m[13] * m[10],
+			m[9] * m[15] - m[13] * m[11],
+			m[10] * m[15] - m[14] * m[11]
+		}
+	};
+}
+
+template <typename T>
+constexpr T determinantFromMinors(TwoByTwoMinors<T> const & minors) {
+	auto const & s = minors.upper;
+	auto const & c = minors.lower;
+	return s[0] * c[5] - s[1] * c[4] + s[2] * c[3] + s[3] * c[2] - s[4] * c[1] + s[5] * c[0];
+}
+
+}
+
+template <typename T, typename A>
+constexpr T determinant(Matrix<4, 4, T, A> const & matrix) {
+	return determinantFromMinors(twoByTwoMinors(matrix));
+}
+
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr bool invertible(Matrix<N, M, T, A> const & matrix) {
 	return !isEqual(determinant(matrix), T(0));
 }
 
 namespace {
 
-template <std::size_t N, std::size_t M, typename T, typename F>
-constexpr auto transformCells(Matrix<N, M, T> const & matrix, F function) {
-	Matrix<N, M, T> result{};
+template <std::size_t N, std::size_t M, typename T, typename A, typename F>
+constexpr auto transformCells(Matrix<N, M, T, A> const & matrix, F function) {
+	Matrix<N, M, T, A> result{};
 	for (auto row = 0_row; row < Row{N}; ++row) {
 		for (auto column = 0_column; column < Column{M}; ++column) {
 			result[row, column] = function(row, column);
@@ -241,8 +473,8 @@ constexpr auto transformCells(Matrix<N, M, T> const & matrix, F function) {
 	return result;
 }
 
-template <std::size_t N, std::size_t M, typename T, typename F>
-constexpr void forAllCells(Matrix<N, M, T> const & matrix, F function) {
+template <std::size_t N, std::size_t M, typename T, typename A, typename F>
+constexpr void forAllCells(Matrix<N, M, T, A> const & matrix, F function) {
 	for (auto row = 0_row; row < Row{N}; ++row) {
 		for (auto column = 0_column; column < Column{M}; ++column) {
 			function(row, column);
@@ -253,31 +485,91 @@ constexpr void forAllCells(Matrix<N, M, T> const & matrix, F function) {
 }
 
 
-template <std::size_t N, std::size_t M, typename T>
-constexpr auto cofactorsOf(Matrix<N, M, T> const & matrix) {
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr auto cofactorsOf(Matrix<N, M, T, A> const & matrix) {
 	return transformCells(matrix, [&](auto row, auto column) {
 		return cofactor(matrix, row, column);
 	});
 }
 
-template <std::size_t N, std::size_t M, typename T>
-constexpr auto minorsOf(Matrix<N, M, T> const & matrix) {
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr auto minorsOf(Matrix<N, M, T, A> const & matrix) {
 	return transformCells(matrix, [&](auto row, auto column) {
 		return minor(matrix, row, column);
 	});
 }
 
 
-template <std::size_t N, std::size_t M, typename T>
-constexpr auto inverse(Matrix<N, M, T> const & matrix) {
-	auto const det = determinant(matrix);
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr auto cofactorInverse(Matrix<N, M, T, A> const & matrix) {
+	auto const det = cofactorDeterminant(matrix);
 	if (isEqual(det, T(0))) {
 		throw std::invalid_argument{"Inverse of matrix with determinant zero is not computable"};
 	}
-	auto const cofactors = cofactorsOf(matrix);
+	auto const cofactors = transformCells(matrix, [&](auto row, auto column) {
+		return expandedCofactor(matrix, row, column);
+	});
 	auto const transposed = transpose(cofactors);
 	return transposed / det;
 }
 
+template <std::size_t N, std::size_t M, typename T, typename A>
+constexpr auto inverse(Matrix<N, M, T, A> const & matrix) {
+	static_assert(N == M, "Inverse is only defined for square matrices");
+	return inverse(luDecompose(matrix));
+}
+
+template <typename T, typename A>
+constexpr Matrix<3, 3, T, A> inverse(Matrix<3, 3, T, A> const & matrix) {
+	auto const & m = matrix.values;
+	T const c00 = m[4] * m[8] - m[5] * m[7];
+	T const c01 = m[5] * m[6] - m[3] * m[8];
+	T const c02 = m[3] * m[7] - m[4] * m[6];
+	auto const det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+	if (isEqual(det, T(0))) {
+		throw std::invalid_argument{"Inverse of matrix with determinant zero is not computable"};
+	}
+	auto const f = 1 / det;
+	return {
+		c00 * f, (m[2] * m[7] - m[1] * m[8]) * f, (m[1] * m[5] - m[2] * m[4]) * f,
+		c01 * f, (m[0] * m[8] - m[2] * m[6]) * f, (m[2] * m[3] - m[0] * m[5]) * f,
+		c02 * f, (m[1] * m[6] - m[0] * m[7]) * f, (m[0] * m[4] - m[1] * m[3]) * f
+	};
+}
+
+template <typename T, typename A>
+constexpr Matrix<4, 4, T, A> inverse(Matrix<4, 4, T, A> const & matrix) {
+	auto const & m = matrix.values;
+	auto const minors = twoByTwoMinors(matrix);
+	auto const & s = minors.upper;
+	auto const & c = minors.lower;
+	auto const det = determinantFromMinors(minors);
+	if (isEqual(det, T(0))) {
+		throw std::invalid_argument{"Inverse of matrix with determinant zero is not computable"};
+	}
+	auto const f = 1 / det;
+	return {
+		( m[5] * c[5] - m[6] * c[4] + m[7] * c[3]) * f,
+		(-m[1] * c[5] + m[2] * c[4] - m[3] * c[3]) * f,
+		( m[13] * s[5] - m[14] * s[4] + m[15] * s[3]) * f,
+		(-m[9] * s[5] + m[10] * s[4] - m[11] * s[3]) * f,
+
+		(-m[4] * c[5] + m[6] * c[2] - m[7] * c[1]) * f,
+		( m[0] * c[5] - m[2] * c[2] + m[3] * c[1]) * f,
+		(-m[12] * s[5] + m[14] * s[2] - m[15] * s[1]) * f,
+		( m[8] * s[5] - m[10] * s[2] + m[11] * s[1]) * f,
+
+		( m[4] * c[4] - m[5] * c[2] + m[7] * c[0]) * f,
+		(-m[0] * c[4] + m[1] * c[2] - m[3] * c[0]) * f,
+		( m[12] * s[4] - m[13] * s[2] + m[15] * s[0]) * f,
+		(-m[8] * s[4] + m[9] * s[2] - m[11] * s[0]) * f,
+
+		(-m[4] * c[3] + m[5] * c[1] - m[6] * c[0]) * f,
+		( m[0] * c[3] - m[1] * c[1] + m[2] * c[0]) * f,
+		(-m[12] * s[3] + m[13] * s[1] - m[14] * s[0]) * f,
+		( m[8] * s[3] - m[9] * s[1] + m[10] * s[0]) * f
+	};
+}
+
 
 #endif /* MATRIX_H_ */
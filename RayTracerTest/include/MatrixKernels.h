@@ -0,0 +1,190 @@
+#ifndef MATRIXKERNELS_H_
+#define MATRIXKERNELS_H_
+
+#include <array>
+#include <cstddef>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define RAYTRACER_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+
+constexpr inline bool isConstantEvaluated() noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_is_constant_evaluated();
+#else
+	return true;
+#endif
+}
+
+namespace kernels {
+
+using MultiplyKernel = void (*)(double const * lhs, double const * rhs, double * result) noexcept;
+
+// Applies the top three rows of a 4x4 matrix to count coordinates stored as
+// separate x, y and z arrays; w is 1 for points and 0 for directions.
+using TransformKernel = void (*)(double const * matrix, double w,
+		double const * x, double const * y, double const * z,
+		double * outX, double * outY, double * outZ, std::size_t count) noexcept;
+
+struct KernelTable {
+	char const * name;
+	MultiplyKernel multiply;
+	TransformKernel transform;
+};
+
+inline void multiplyScalar(double const * lhs, double const * rhs, double * result) noexcept {
+	for (auto row = 0u; row < 4; ++row) {
+		double const * const lhsRow = lhs + row * 4;
+		for (auto column = 0u; column < 4; ++column) {
+			result[row * 4 + column] =
+					lhsRow[0] * rhs[column] +
+					lhsRow[1] * rhs[4 + column] +
+					lhsRow[2] * rhs[8 + column] +
+					lhsRow[3] * rhs[12 + column];
+		}
+	}
+}
+
+inline void transformScalar(double const * m, double const w,
+		double const * x, double const * y, double const * z,
+		double * outX, double * outY, double * outZ, std::size_t const count) noexcept {
+	double const offsetX = m[3] * w;
+	double const offsetY = m[7] * w;
+	double const offsetZ = m[11] * w;
+	for (std::size_t index = 0; index < count; ++index) {
+		double const px = x[index];
+		double const py = y[index];
+		double const pz = z[index];
+		outX[index] = m[0] * px + m[1] * py + m[2] * pz + offsetX;
+		outY[index] = m[4] * px + m[5] * py + m[6] * pz + offsetY;
+		outZ[index] = m[8] * px + m[9] * py + m[10] * pz + offsetZ;
+	}
+}
+
+inline constexpr KernelTable scalar{"scalar", multiplyScalar, transformScalar};
+
+#ifdef RAYTRACER_X86_KERNELS
+
+inline void multiplySse2(double const * lhs, double const * rhs, double * result) noexcept {
+	__m128d const rhsLow[4] {
+		_mm_loadu_pd(rhs), _mm_loadu_pd(rhs + 4), _mm_loadu_pd(rhs + 8), _mm_loadu_pd(rhs + 12)
+	};
+	__m128d const rhsHigh[4] {
+		_mm_loadu_pd(rhs + 2), _mm_loadu_pd(rhs + 6), _mm_loadu_pd(rhs + 10), _mm_loadu_pd(rhs + 14)
+	};
+	for (auto row = 0u; row < 4; ++row) {
+		__m128d low = _mm_setzero_pd();
+		__m128d high = _mm_setzero_pd();
+		for (auto component = 0u; component < 4; ++component) {
+			__m128d const factor = _mm_set1_pd(lhs[row * 4 + component]);
+			low = _mm_add_pd(low, _mm_mul_pd(factor, rhsLow[component]));
+			high = _mm_add_pd(high, _mm_mul_pd(factor, rhsHigh[component]));
+		}
+		_mm_storeu_pd(result + row * 4, low);
+		_mm_storeu_pd(result + row * 4 + 2, high);
+	}
+}
+
+inline void transformSse2(double const * m, double const w,
+		double const * x, double const * y, double const * z,
+		double * outX, double * outY, double * outZ, std::size_t const count) noexcept {
+	__m128d row[3][4];
+	for (auto index = 0u; index < 3; ++index) {
+		row[index][0] = _mm_set1_pd(m[index * 4]);
+		row[index][1] = _mm_set1_pd(m[index * 4 + 1]);
+		row[index][2] = _mm_set1_pd(m[index * 4 + 2]);
+		row[index][3] = _mm_set1_pd(m[index * 4 + 3] * w);
+	}
+	double * const out[3]{outX, outY, outZ};
+	std::size_t index = 0;
+	for (; index + 2 <= count; index += 2) {
+		__m128d const px = _mm_loadu_pd(x + index);
+		__m128d const py = _mm_loadu_pd(y + index);
+		__m128d const pz = _mm_loadu_pd(z + index);
+		for (auto component = 0u; component < 3; ++component) {
+			__m128d value = _mm_add_pd(row[component][3], _mm_mul_pd(row[component][0], px));
+			value = _mm_add_pd(value, _mm_mul_pd(row[component][1], py));
+			value = _mm_add_pd(value, _mm_mul_pd(row[component][2], pz));
+			_mm_storeu_pd(out[component] + index, value);
+		}
+	}
+	transformScalar(m, w, x + index, y + index, z + index, outX + index, outY + index, outZ + index, count - index);
+}
+
+inline constexpr KernelTable sse2{"sse2", multiplySse2, transformSse2};
+
+__attribute__((target("avx2,fma")))
+inline void multiplyAvx2(double const * lhs, double const * rhs, double * result) noexcept {
+	__m256d const rhsRows[4] {
+		_mm256_loadu_pd(rhs), _mm256_loadu_pd(rhs + 4), _mm256_loadu_pd(rhs + 8), _mm256_loadu_pd(rhs + 12)
+	};
+	for (auto row = 0u; row < 4; ++row) {
+		double const * const lhsRow = lhs + row * 4;
+		__m256d value = _mm256_mul_pd(_mm256_broadcast_sd(lhsRow), rhsRows[0]);
+		value = _mm256_fmadd_pd(_mm256_broadcast_sd(lhsRow + 1), rhsRows[1], value);
+		value = _mm256_fmadd_pd(_mm256_broadcast_sd(lhsRow + 2), rhsRows[2], value);
+		value = _mm256_fmadd_pd(_mm256_broadcast_sd(lhsRow + 3), rhsRows[3], value);
+		_mm256_storeu_pd(result + row * 4, value);
+	}
+}
+
+__attribute__((target("avx2,fma")))
+inline void transformAvx2(double const * m, double const w,
+		double const * x, double const * y, double const * z,
+		double * outX, double * outY, double * outZ, std::size_t const count) noexcept {
+	__m256d row[3][4];
+	for (auto index = 0u; index < 3; ++index) {
+		row[index][0] = _mm256_set1_pd(m[index * 4]);
+		row[index][1] = _mm256_set1_pd(m[index * 4 + 1]);
+		row[index][2] = _mm256_set1_pd(m[index * 4 + 2]);
+		row[index][3] = _mm256_set1_pd(m[index * 4 + 3] * w);
+	}
+	double * const out[3]{outX, outY, outZ};
+	std::size_t index = 0;
+	for (; index + 4 <= count; index += 4) {
+		__m256d const px = _mm256_loadu_pd(x + index);
+		__m256d const py = _mm256_loadu_pd(y + index);
+		__m256d const pz = _mm256_loadu_pd(z + index);
+		for (auto component = 0u; component < 3; ++component) {
+			__m256d value = _mm256_fmadd_pd(row[component][0], px, row[component][3]);
+			value = _mm256_fmadd_pd(row[component][1], py, value);
+			value = _mm256_fmadd_pd(row[component][2], pz, value);
+			_mm256_storeu_pd(out[component] + index, value);
+		}
+	}
+	transformScalar(m, w, x + index, y + index, z + index, outX + index, outY + index, outZ + index, count - index);
+}
+
+inline constexpr KernelTable avx2{"avx2", multiplyAvx2, transformAvx2};
+
+#endif
+
+inline bool supported(KernelTable const & table) noexcept {
+#ifdef RAYTRACER_X86_KERNELS
+	if (&table == &avx2) {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	}
+#endif
+	return true;
+}
+
+inline KernelTable const & selectKernels() noexcept {
+#ifdef RAYTRACER_X86_KERNELS
+	return supported(avx2) ? avx2 : sse2;
+#else
+	return scalar;
+#endif
+}
+
+inline KernelTable const & active() noexcept {
+	static KernelTable const & table = selectKernels();
+	return table;
+}
+
+}
+
+
+#endif /* MATRIXKERNELS_H_ */
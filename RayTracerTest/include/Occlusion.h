@@ -0,0 +1,99 @@
+#ifndef OCCLUSION_H_
+#define OCCLUSION_H_
+
+#include "BoundingBox.h"
+#include "Intersections.h"
+#include "Light.h"
+#include "Point.h"
+#include "Ray.h"
+#include "Scene.h"
+#include "Span.h"
+#include "Sphere.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Work done by shadow queries, kept apart from the counters of camera rays
+// since shadow rays usually outnumber them.
+struct OcclusionCounters {
+	std::size_t queries{};
+	std::size_t occluded{};
+	std::size_t nodesVisited{};
+	std::size_t shapesTested{};
+
+	constexpr OcclusionCounters & operator+=(OcclusionCounters const & other) noexcept {
+		queries += other.queries;
+		occluded += other.occluded;
+		nodesVisited += other.nodesVisited;
+		shapesTested += other.shapesTested;
+		return *this;
+	}
+};
+
+// The segment from point to the light as times [0, 1) of this ray. Its
+// direction is not normalized, which saves a square root per query.
+template <typename T>
+constexpr BasicRay<T> shadowRay(BasicPoint<T> const & point, BasicLight<T> const & light) {
+	return BasicRay<T>{point, light.position - point};
+}
+
+// Whether sphere is hit at a time in [0, maxTime) along ray.
+template <typename T>
+constexpr bool blocks(Shapes::BasicSphere<T> const & sphere, BasicRay<T> const & ray, T const maxTime) {
+	return hitTime(sphere, ray, maxTime).has_value();
+}
+
+// Whether any of shapes lies between point and light. Stops at the first
+// shape that does. point should already be offset from the surface it
+// lies on, or that surface may shadow itself.
+template <typename T>
+bool isOccluded(NonDeduced<Span<Shapes::BasicSphere<T> const>> const shapes, BasicPoint<T> const & point, BasicLight<T> const & light, OcclusionCounters & counters) {
+	auto const ray = shadowRay(point, light);
+	++counters.queries;
+	for (auto const & shape : shapes) {
+		++counters.shapesTested;
+		if (blocks(shape, ray, T(1))) {
+			++counters.occluded;
+			return true;
+		}
+	}
+	return false;
+}
+
+template <typename T>
+bool isOccluded(NonDeduced<Span<Shapes::BasicSphere<T> const>> const shapes, BasicPoint<T> const & point, BasicLight<T> const & light) {
+	OcclusionCounters counters{};
+	return isOccluded(shapes, point, light, counters);
+}
+
+// As isOccluded() over the shapes of scene, but skips the quadratic of
+// every shape whose cached bounds the segment to the light misses. Those
+// shapes do not count as tested.
+template <typename T>
+bool isOccluded(BasicScene<T> const & scene, BasicPoint<T> const & point, BasicLight<T> const & light, OcclusionCounters & counters) {
+	auto const ray = shadowRay(point, light);
+	BasicPrecomputedRay<T> const precomputed{ray, T(0), T(1)};
+	++counters.queries;
+	for (std::uint32_t shape = 0; shape < scene.size(); ++shape) {
+		T entry{};
+		if (!intersects(scene.bounds(ShapeId{shape}), precomputed, entry)) {
+			continue;
+		}
+		++counters.shapesTested;
+		if (blocks(scene.spheres()[shape], ray, T(1))) {
+			++counters.occluded;
+			return true;
+		}
+	}
+	return false;
+}
+
+template <typename T>
+bool isOccluded(BasicScene<T> const & scene, BasicPoint<T> const & point, BasicLight<T> const & light) {
+	OcclusionCounters counters{};
+	return isOccluded(scene, point, light, counters);
+}
+
+
+#endif /* OCCLUSION_H_ */
@@ -4,7 +4,7 @@
 #include <boost/math/constants/constants.hpp>
 
 template <typename T>
-constexpr auto pi = boost::math::constants::pi<double>();
+constexpr auto pi = boost::math::constants::pi<T>();
 
 
 
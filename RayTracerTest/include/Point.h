@@ -7,26 +7,34 @@
 
 #include <ostream>
 
-struct Point : Coordinate<Point>, operators::addable<Point, Direction>, operators::subtractable<Point, Direction> {
-	using Coordinate<Point>::Coordinate;
+template <typename T>
+struct BasicPoint : Coordinate<BasicPoint<T>, T>, operators::addable<BasicPoint<T>, BasicDirection<T>>, operators::subtractable<BasicPoint<T>, BasicDirection<T>> {
+	using Coordinate<BasicPoint<T>, T>::Coordinate;
 };
 
-inline std::ostream & operator<<(std::ostream & out, Point const & point) {
-	return out << "Point" << static_cast<Coordinate<Point> const>(point);
+using Point = BasicPoint<double>;
+using PointF = BasicPoint<float>;
+
+template <typename T>
+std::ostream & operator<<(std::ostream & out, BasicPoint<T> const & point) {
+	return out << "Point" << static_cast<Coordinate<BasicPoint<T>, T> const>(point);
 }
 
-constexpr inline Point & operator+=(Point & point, Direction const & direction) noexcept {
+template <typename T>
+constexpr BasicPoint<T> & operator+=(BasicPoint<T> & point, BasicDirection<T> const & direction) noexcept {
 	point.x += direction.x;
 	point.y += direction.y;
 	point.z += direction.z;
 	return point;
 }
 
-constexpr inline Direction operator-(Point const & end, Point const & start) noexcept {
+template <typename T>
+constexpr BasicDirection<T> operator-(BasicPoint<T> const & end, BasicPoint<T> const & start) noexcept {
 	return {end.x - start.x, end.y - start.y, end.z - start.z};
 }
 
-constexpr inline Point & operator-=(Point & start, Direction const & direction) noexcept {
+template <typename T>
+constexpr BasicPoint<T> & operator-=(BasicPoint<T> & start, BasicDirection<T> const & direction) noexcept {
 	return start += -direction;
 }
 
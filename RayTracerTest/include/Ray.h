@@ -1,37 +1,99 @@
 #ifndef RAY_H_
 #define RAY_H_
 
+#include "AffineTransform.h"
 #include "Direction.h"
 #include "Matrix.h"
 #include "Operators.h"
 #include "Point.h"
+#include "Transform.h"
+#include "Transformations.h"
 
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <ostream>
 #include <variant>
 
 
-struct Ray : private operators::equality_comparable<Ray> {
-	Point const origin;
-	Direction const direction;
+template <typename T>
+struct BasicRay : private operators::equality_comparable<BasicRay<T>> {
+	BasicPoint<T> const origin;
+	BasicDirection<T> const direction;
 
-	explicit constexpr Ray(Point const origin = {}, Direction const direction = {}) :
+	explicit constexpr BasicRay(BasicPoint<T> const origin = {}, BasicDirection<T> const direction = {}) :
 			origin{origin}, direction{direction}{}
 
-	constexpr bool operator==(Ray const & other) const {
+	constexpr bool operator==(BasicRay const & other) const {
 		return origin == other.origin && direction == other.direction;
 	}
 
-	constexpr Point position(double const time) const {
+	constexpr BasicPoint<T> position(T const time) const {
 		return origin + direction * time;
 	}
 
-	template<typename ValueType = double>
-	constexpr auto transform(Matrix<4, 4, ValueType> const & matrix) const {
-		return Ray{matrix * origin, matrix * direction};
+	template<typename Access = DefaultAccess>
+	constexpr auto transform(Matrix<4, 4, T, Access> const & matrix) const {
+		return BasicRay{matrix * origin, matrix * direction};
+	}
+
+	constexpr BasicRay transform(BasicAffineTransform<T> const & affine) const {
+		return BasicRay{affine * origin, affine * direction};
+	}
+
+	constexpr BasicRay toObjectSpace(BasicTransform<T> const & objectTransform) const {
+		return transform(objectTransform.inverse());
+	}
+};
+
+using Ray = BasicRay<double>;
+using RayF = BasicRay<float>;
+
+// A ray prepared for testing many boxes: the reciprocal of its direction,
+// so slab tests need no divides, the signs of the direction components,
+// which pick the near plane of each slab and order traversal front to
+// back, and the interval [tMin, tMax] that is searched. Transforming keeps
+// the interval, as the direction is not renormalized.
+template <typename T>
+struct BasicPrecomputedRay : BasicRay<T> {
+	BasicDirection<T> const inverseDirection;
+	// 1 where the direction component is negative, including -0.
+	std::array<std::uint8_t, 3> const sign;
+	T tMin;
+	T tMax;
+
+	explicit constexpr BasicPrecomputedRay(BasicRay<T> const & ray, T const tMin = T(0), T const tMax = std::numeric_limits<T>::infinity()) :
+			BasicRay<T>{ray},
+			inverseDirection{T(1) / ray.direction.x, T(1) / ray.direction.y, T(1) / ray.direction.z},
+			sign{negative(inverseDirection.x), negative(inverseDirection.y), negative(inverseDirection.z)},
+			tMin{tMin}, tMax{tMax} {
+	}
+
+	// Index 0 to 7 of the octant the direction points into.
+	constexpr unsigned octant() const noexcept {
+		return sign[0] | sign[1] << 1 | sign[2] << 2;
+	}
+
+	template<typename Access = DefaultAccess>
+	constexpr BasicPrecomputedRay transform(Matrix<4, 4, T, Access> const & matrix) const {
+		return BasicPrecomputedRay{BasicRay<T>::transform(matrix), tMin, tMax};
+	}
+
+	constexpr BasicPrecomputedRay toObjectSpace(BasicTransform<T> const & objectTransform) const {
+		return transform(objectTransform.inverse());
+	}
+
+private:
+	static constexpr std::uint8_t negative(T const inverse) noexcept {
+		return inverse < T(0) ? 1 : 0;
 	}
 };
 
-inline std::ostream & operator<<(std::ostream & out, Ray const & ray) {
+using PrecomputedRay = BasicPrecomputedRay<double>;
+using PrecomputedRayF = BasicPrecomputedRay<float>;
+
+template <typename T>
+std::ostream & operator<<(std::ostream & out, BasicRay<T> const & ray) {
 	return out << "Ray{" << ray.origin << "} {" << ray.direction << '}';
 }
 
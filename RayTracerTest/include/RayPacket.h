@@ -0,0 +1,201 @@
+#ifndef RAYPACKET_H_
+#define RAYPACKET_H_
+
+#include "Intersections.h"
+#include "Point.h"
+#include "Ray.h"
+#include "SimdLanes.h"
+#include "Span.h"
+#include "Sphere.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+
+// N coherent rays, such as those of neighbouring pixels, stored as one
+// array per coordinate so that a SIMD register holds a coordinate of
+// several rays.
+template <typename T, std::size_t N>
+struct BasicRayPacket {
+	static_assert(N % 4 == 0, "Packets are processed four lanes at a time");
+	static constexpr std::size_t kWidth{N};
+
+	alignas(16) std::array<T, N> originX{};
+	alignas(16) std::array<T, N> originY{};
+	alignas(16) std::array<T, N> originZ{};
+	alignas(16) std::array<T, N> directionX{};
+	alignas(16) std::array<T, N> directionY{};
+	alignas(16) std::array<T, N> directionZ{};
+
+	constexpr void set(std::size_t const lane, BasicRay<T> const & ray) noexcept {
+		originX[lane] = ray.origin.x;
+		originY[lane] = ray.origin.y;
+		originZ[lane] = ray.origin.z;
+		directionX[lane] = ray.direction.x;
+		directionY[lane] = ray.direction.y;
+		directionZ[lane] = ray.direction.z;
+	}
+
+	constexpr BasicRay<T> operator[](std::size_t const lane) const noexcept {
+		return BasicRay<T>{{originX[lane], originY[lane], originZ[lane]}, {directionX[lane], directionY[lane], directionZ[lane]}};
+	}
+};
+
+// Four lanes fill an SSE register of floats, eight an AVX register.
+template <typename T>
+using RayPacket4Of = BasicRayPacket<T, 4>;
+template <typename T>
+using RayPacket8Of = BasicRayPacket<T, 8>;
+
+using RayPacket4 = RayPacket4Of<double>;
+using RayPacket4F = RayPacket4Of<float>;
+using RayPacket8 = RayPacket8Of<double>;
+using RayPacket8F = RayPacket8Of<float>;
+
+// Nearest hit of each lane of a packet; lanes without a hit have an
+// infinite time and are clear in mask.
+template <typename T, std::size_t N>
+struct BasicPacketHit {
+	std::array<T, N> time{};
+	std::array<ShapeId, N> shape{};
+	unsigned mask{};
+};
+
+namespace {
+
+// What the packet kernel needs of a sphere: the world space center and
+// radius if its transform is a similarity, otherwise the top rows of its
+// inverse to take the rays to object space, where it is the unit sphere.
+template <typename T>
+struct PacketSphere {
+	bool objectSpace;
+	std::array<T, 12> inverse;
+	BasicPoint<T> center;
+	T radiusSquared;
+};
+
+template <typename T>
+PacketSphere<T> packetSphere(Shapes::BasicSphere<T> const & sphere) {
+	PacketSphere<T> result{};
+	if (auto const radius = sphere.transform.similarityScale(); radius != T(0)) {
+		result.center = Shapes::center(sphere);
+		result.radiusSquared = radius * radius;
+		return result;
+	}
+	auto const & inverse = sphere.transform.inverse().values;
+	result.objectSpace = true;
+	for (std::size_t index = 0; index < result.inverse.size(); ++index) {
+		result.inverse[index] = inverse[index];
+	}
+	result.center = sphere.position;
+	result.radiusSquared = T(1);
+	return result;
+}
+
+// sphereQuadratic() and hitTime() for Lanes::kCount rays at a time.
+template <typename Lanes, typename T, std::size_t N>
+unsigned intersectLanes(PacketSphere<T> const & sphere, BasicRayPacket<T, N> const & packet, std::array<T, N> const & tMax, std::array<T, N> & times) noexcept {
+	using L = Lanes;
+	auto const centerX = L::broadcast(sphere.center.x);
+	auto const centerY = L::broadcast(sphere.center.y);
+	auto const centerZ = L::broadcast(sphere.center.z);
+	auto const radiusSquared = L::broadcast(sphere.radiusSquared);
+	unsigned mask{};
+	for (std::size_t lane = 0; lane < N; lane += L::kCount) {
+		auto originX = L::load(packet.originX.data() + lane);
+		auto originY = L::load(packet.originY.data() + lane);
+		auto originZ = L::load(packet.originZ.data() + lane);
+		auto directionX = L::load(packet.directionX.data() + lane);
+		auto directionY = L::load(packet.directionY.data() + lane);
+		auto directionZ = L::load(packet.directionZ.data() + lane);
+		if (sphere.objectSpace) {
+			auto const & m = sphere.inverse;
+			auto const row = [&](std::size_t const first, typename L::Register const x, typename L::Register const y, typename L::Register const z) {
+				return L::add(L::add(L::multiply(L::broadcast(m[first]), x), L::multiply(L::broadcast(m[first + 1]), y)), L::multiply(L::broadcast(m[first + 2]), z));
+			};
+			auto const objectOriginX = L::add(row(0, originX, originY, originZ), L::broadcast(m[3]));
+			auto const objectOriginY = L::add(row(4, originX, originY, originZ), L::broadcast(m[7]));
+			auto const objectOriginZ = L::add(row(8, originX, originY, originZ), L::broadcast(m[11]));
+			auto const objectDirectionX = row(0, directionX, directionY, directionZ);
+			auto const objectDirectionY = row(4, directionX, directionY, directionZ);
+			auto const objectDirectionZ = row(8, directionX, directionY, directionZ);
+			originX = objectOriginX;
+			originY = objectOriginY;
+			originZ = objectOriginZ;
+			directionX = objectDirectionX;
+			directionY = objectDirectionY;
+			directionZ = objectDirectionZ;
+		}
+		auto const dot = [](auto const ax, auto const ay, auto const az, auto const bx, auto const by, auto const bz) {
+			return L::add(L::add(L::multiply(ax, bx), L::multiply(ay, by)), L::multiply(az, bz));
+		};
+		auto const toRayX = L::subtract(originX, centerX);
+		auto const toRayY = L::subtract(originY, centerY);
+		auto const toRayZ = L::subtract(originZ, centerZ);
+		auto const a = dot(directionX, directionY, directionZ, directionX, directionY, directionZ);
+		auto const halfB = dot(directionX, directionY, directionZ, toRayX, toRayY, toRayZ);
+		auto const c = L::subtract(dot(toRayX, toRayY, toRayZ, toRayX, toRayY, toRayZ), radiusSquared);
+		auto const inverseA = L::divide(L::broadcast(T(1)), a);
+		auto const along = L::multiply(halfB, inverseA);
+		auto const perpendicularX = L::subtract(toRayX, L::multiply(directionX, along));
+		auto const perpendicularY = L::subtract(toRayY, L::multiply(directionY, along));
+		auto const perpendicularZ = L::subtract(toRayZ, L::multiply(directionZ, along));
+		auto const perpendicularSquared = dot(perpendicularX, perpendicularY, perpendicularZ, perpendicularX, perpendicularY, perpendicularZ);
+		auto time = L::load(times.data() + lane);
+		auto const hits = nearestRoot<L>(a, inverseA, halfB, c, radiusSquared, perpendicularSquared, L::load(tMax.data() + lane), time);
+		L::store(times.data() + lane, time);
+		mask |= L::bits(hits) << lane;
+	}
+	return mask;
+}
+
+}
+
+// Intersects every lane of packet with sphere. Returns a bit per lane that
+// hits it at a time in [0, tMax) and stores that time for those lanes;
+// times of the other lanes are left as they are. tMax and times may be
+// the same array. Throws std::invalid_argument if the transform of sphere
+// is not invertible, as intersect() for a single ray does.
+template <typename T, std::size_t N>
+unsigned intersect(Shapes::BasicSphere<T> const & sphere, BasicRayPacket<T, N> const & packet, std::array<T, N> const & tMax, std::array<T, N> & times) {
+	return intersectLanes<SimdLanes<T>>(packetSphere(sphere), packet, tMax, times);
+}
+
+// Nearest hit of each lane among shapes, as World::hit() without an
+// accelerator.
+template <typename T, std::size_t N>
+BasicPacketHit<T, N> hit(NonDeduced<Span<Shapes::BasicSphere<T> const>> const shapes, BasicRayPacket<T, N> const & packet) {
+	BasicPacketHit<T, N> result{};
+	result.time.fill(std::numeric_limits<T>::infinity());
+	for (std::uint32_t shape = 0; shape < shapes.size(); ++shape) {
+		auto lanes = intersect(shapes[shape], packet, result.time, result.time);
+		result.mask |= lanes;
+		for (std::size_t lane = 0; lanes != 0; ++lane, lanes >>= 1) {
+			if (lanes & 1u) {
+				result.shape[lane] = ShapeId{shape};
+			}
+		}
+	}
+	return result;
+}
+
+// Which of the given lanes hit one of shapes at a time in [0, maxTime),
+// as isOccluded() does for shadow rays. Stops once all of them do.
+template <typename T, std::size_t N>
+unsigned occluded(NonDeduced<Span<Shapes::BasicSphere<T> const>> const shapes, BasicRayPacket<T, N> const & packet, std::array<T, N> const & maxTime, unsigned const lanes = (1u << N) - 1) {
+	std::array<T, N> times{};
+	unsigned result{};
+	for (auto const & shape : shapes) {
+		result |= intersect(shape, packet, maxTime, times) & lanes;
+		if (result == lanes) {
+			break;
+		}
+	}
+	return result;
+}
+
+
+#endif /* RAYPACKET_H_ */
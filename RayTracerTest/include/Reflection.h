@@ -3,7 +3,8 @@
 
 #include "Direction.h"
 
-constexpr Direction reflect(Direction const & in, Direction const & normal) {
+template <typename T>
+constexpr BasicDirection<T> reflect(BasicDirection<T> const & in, BasicDirection<T> const & normal) {
 	return in - normal * 2 * dot(in, normal);
 }
 
@@ -0,0 +1,74 @@
+#ifndef SCENE_H_
+#define SCENE_H_
+
+#include "BoundingBox.h"
+#include "Intersections.h"
+#include "Ray.h"
+#include "Sphere.h"
+#include "Transform.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+
+// Owns the shapes of a scene and their world space bounds; intersections
+// refer to shapes by ShapeId.
+template <typename T>
+class BasicScene {
+	std::vector<Shapes::BasicSphere<T>> spheres_{};
+	std::vector<BasicBoundingBox<T>> bounds_{};
+
+public:
+	ShapeId add(Shapes::BasicSphere<T> const & sphere) {
+		if (spheres_.size() > std::numeric_limits<std::uint32_t>::max()) {
+			throw std::invalid_argument{"Scene cannot hold more shapes"};
+		}
+		spheres_.push_back(sphere);
+		bounds_.push_back(Shapes::bounds(sphere));
+		return ShapeId{static_cast<std::uint32_t>(spheres_.size() - 1)};
+	}
+
+	Shapes::BasicSphere<T> const & operator[](ShapeId const id) const {
+		if (id.value >= spheres_.size()) {
+			throw std::invalid_argument{"Invalid shape id"};
+		}
+		return spheres_[id.value];
+	}
+
+	void setTransform(ShapeId const id, BasicTransform<T> const & transform) {
+		if (id.value >= spheres_.size()) {
+			throw std::invalid_argument{"Invalid shape id"};
+		}
+		spheres_[id.value].transform = transform;
+		bounds_[id.value] = Shapes::bounds(spheres_[id.value]);
+	}
+
+	BasicBoundingBox<T> const & bounds(ShapeId const id) const noexcept {
+		return bounds_[id.value];
+	}
+
+	std::vector<BasicBoundingBox<T>> const & bounds() const noexcept {
+		return bounds_;
+	}
+
+	std::size_t size() const noexcept {
+		return spheres_.size();
+	}
+
+	std::vector<Shapes::BasicSphere<T>> const & spheres() const noexcept {
+		return spheres_;
+	}
+
+	BasicIntersectionResult<T> intersect(ShapeId const id, BasicRay<T> const & ray) const {
+		return ::intersect((*this)[id], ray, id);
+	}
+};
+
+using Scene = BasicScene<double>;
+using SceneF = BasicScene<float>;
+
+
+#endif /* SCENE_H_ */
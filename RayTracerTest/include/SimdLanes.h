@@ -0,0 +1,143 @@
+#ifndef SIMDLANES_H_
+#define SIMDLANES_H_
+
+#include "MatrixKernels.h"
+
+#include <cmath>
+#include <cstddef>
+
+
+// Lanes types do arithmetic on as many values as one register holds, so
+// that kernels are written once for each instruction set. A Mask holds
+// the outcome of a comparison per lane.
+namespace {
+
+// One lane at a time, for targets without SIMD kernels.
+template <typename T>
+struct ScalarLanes {
+	using Value = T;
+	using Register = T;
+	using Mask = bool;
+	static constexpr std::size_t kCount{1};
+
+	static Register load(T const * source) noexcept { return *source; }
+	static void store(T * target, Register const value) noexcept { *target = value; }
+	static Register broadcast(T const value) noexcept { return value; }
+	static Register add(Register const lhs, Register const rhs) noexcept { return lhs + rhs; }
+	static Register subtract(Register const lhs, Register const rhs) noexcept { return lhs - rhs; }
+	static Register multiply(Register const lhs, Register const rhs) noexcept { return lhs * rhs; }
+	static Register divide(Register const lhs, Register const rhs) noexcept { return lhs / rhs; }
+	static Register squareRoot(Register const value) noexcept { return std::sqrt(value); }
+	static Register minimum(Register const lhs, Register const rhs) noexcept { return rhs < lhs ? rhs : lhs; }
+	static Register maximum(Register const lhs, Register const rhs) noexcept { return lhs < rhs ? rhs : lhs; }
+	static Mask less(Register const lhs, Register const rhs) noexcept { return lhs < rhs; }
+	static Mask lessEqual(Register const lhs, Register const rhs) noexcept { return lhs <= rhs; }
+	static Mask equal(Register const lhs, Register const rhs) noexcept { return lhs == rhs; }
+	static Mask both(Mask const lhs, Mask const rhs) noexcept { return lhs && rhs; }
+	static Register select(Mask const mask, Register const whenSet, Register const otherwise) noexcept { return mask ? whenSet : otherwise; }
+	static unsigned bits(Mask const mask) noexcept { return mask ? 1u : 0u; }
+};
+
+#ifdef RAYTRACER_X86_KERNELS
+
+template <typename T>
+struct SseLanes;
+
+template <>
+struct SseLanes<float> {
+	using Value = float;
+	using Register = __m128;
+	using Mask = __m128;
+	static constexpr std::size_t kCount{4};
+
+	static Register load(float const * source) noexcept { return _mm_loadu_ps(source); }
+	static void store(float * target, Register const value) noexcept { _mm_storeu_ps(target, value); }
+	static Register broadcast(float const value) noexcept { return _mm_set1_ps(value); }
+	static Register add(Register const lhs, Register const rhs) noexcept { return _mm_add_ps(lhs, rhs); }
+	static Register subtract(Register const lhs, Register const rhs) noexcept { return _mm_sub_ps(lhs, rhs); }
+	static Register multiply(Register const lhs, Register const rhs) noexcept { return _mm_mul_ps(lhs, rhs); }
+	static Register divide(Register const lhs, Register const rhs) noexcept { return _mm_div_ps(lhs, rhs); }
+	static Register squareRoot(Register const value) noexcept { return _mm_sqrt_ps(value); }
+	static Register minimum(Register const lhs, Register const rhs) noexcept { return _mm_min_ps(lhs, rhs); }
+	static Register maximum(Register const lhs, Register const rhs) noexcept { return _mm_max_ps(lhs, rhs); }
+	static Mask less(Register const lhs, Register const rhs) noexcept { return _mm_cmplt_ps(lhs, rhs); }
+	static Mask lessEqual(Register const lhs, Register const rhs) noexcept { return _mm_cmple_ps(lhs, rhs); }
+	static Mask equal(Register const lhs, Register const rhs) noexcept { return _mm_cmpeq_ps(lhs, rhs); }
+	static Mask both(Mask const lhs, Mask const rhs) noexcept { return _mm_and_ps(lhs, rhs); }
+	static Register select(Mask const mask, Register const whenSet, Register const otherwise) noexcept {
+		return _mm_or_ps(_mm_and_ps(mask, whenSet), _mm_andnot_ps(mask, otherwise));
+	}
+	static unsigned bits(Mask const mask) noexcept { return static_cast<unsigned>(_mm_movemask_ps(mask)); }
+};
+
+template <>
+struct SseLanes<double> {
+	using Value = double;
+	using Register = __m128d;
+	using Mask = __m128d;
+	static constexpr std::size_t kCount{2};
+
+	static Register load(double const * source) noexcept { return _mm_loadu_pd(source); }
+	static void store(double * target, Register const value) noexcept { _mm_storeu_pd(target, value); }
+	static Register broadcast(double const value) noexcept { return _mm_set1_pd(value); }
+	static Register add(Register const lhs, Register const rhs) noexcept { return _mm_add_pd(lhs, rhs); }
+	static Register subtract(Register const lhs, Register const rhs) noexcept { return _mm_sub_pd(lhs, rhs); }
+	static Register multiply(Register const lhs, Register const rhs) noexcept { return _mm_mul_pd(lhs, rhs); }
+	static Register divide(Register const lhs, Register const rhs) noexcept { return _mm_div_pd(lhs, rhs); }
+	static Register squareRoot(Register const value) noexcept { return _mm_sqrt_pd(value); }
+	static Register minimum(Register const lhs, Register const rhs) noexcept { return _mm_min_pd(lhs, rhs); }
+	static Register maximum(Register const lhs, Register const rhs) noexcept { return _mm_max_pd(lhs, rhs); }
+	static Mask less(Register const lhs, Register const rhs) noexcept { return _mm_cmplt_pd(lhs, rhs); }
+	static Mask lessEqual(Register const lhs, Register const rhs) noexcept { return _mm_cmple_pd(lhs, rhs); }
+	static Mask equal(Register const lhs, Register const rhs) noexcept { return _mm_cmpeq_pd(lhs, rhs); }
+	static Mask both(Mask const lhs, Mask const rhs) noexcept { return _mm_and_pd(lhs, rhs); }
+	static Register select(Mask const mask, Register const whenSet, Register const otherwise) noexcept {
+		return _mm_or_pd(_mm_and_pd(mask, whenSet), _mm_andnot_pd(mask, otherwise));
+	}
+	static unsigned bits(Mask const mask) noexcept { return static_cast<unsigned>(_mm_movemask_pd(mask)); }
+};
+
+template <typename T>
+using SimdLanes = SseLanes<T>;
+
+#else
+
+template <typename T>
+using SimdLanes = ScalarLanes<T>;
+
+#endif
+
+// The root selection of solve() and hitTime(), for Lanes::kCount
+// quadratics at once and without branches. A lane hits if its
+// discriminant is not negative and its nearest non-negative root lies
+// below limit; time takes that root in those lanes and keeps its value in
+// the others.
+template <typename Lanes>
+typename Lanes::Mask nearestRoot(typename Lanes::Register const a, typename Lanes::Register const inverseA, typename Lanes::Register const halfB, typename Lanes::Register const c,
+		typename Lanes::Register const radiusSquared, typename Lanes::Register const perpendicularSquared, typename Lanes::Register const limit, typename Lanes::Register & time) noexcept {
+	using L = Lanes;
+	auto const zero = L::broadcast(typename L::Value(0));
+	auto const discriminant = L::multiply(a, L::subtract(radiusSquared, perpendicularSquared));
+	auto const root = L::squareRoot(L::maximum(discriminant, zero));
+	auto const q = L::subtract(zero, L::add(halfB, L::select(L::less(halfB, zero), L::subtract(zero, root), root)));
+	auto const first = L::multiply(q, inverseA);
+	auto const second = L::select(L::equal(q, zero), zero, L::divide(c, q));
+	auto const near = L::minimum(first, second);
+	auto const far = L::maximum(first, second);
+	auto const nearest = L::select(L::lessEqual(zero, near), near, far);
+	auto const hits = L::both(L::both(L::lessEqual(zero, discriminant), L::lessEqual(zero, nearest)), L::less(nearest, limit));
+	time = L::select(hits, nearest, time);
+	return hits;
+}
+
+}
+
+// Instruction set of SimdLanes, for reports.
+#ifdef RAYTRACER_X86_KERNELS
+inline constexpr char const * simdKernel{"sse2"};
+#else
+inline constexpr char const * simdKernel{"scalar"};
+#endif
+
+
+#endif /* SIMDLANES_H_ */
@@ -0,0 +1,76 @@
+#ifndef SPAN_H_
+#define SPAN_H_
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+
+// Minimal stand-in for C++20 std::span: a non-owning view of contiguous elements.
+template <typename T>
+class Span {
+	T * data_{};
+	std::size_t size_{};
+
+public:
+	constexpr Span() noexcept = default;
+
+	constexpr Span(T * data, std::size_t const size) noexcept :
+			data_{data}, size_{size} {
+	}
+
+	template <typename Container, typename = std::enable_if_t<std::is_convertible_v<decltype(std::declval<Container &>().data()), T *>>>
+	constexpr Span(Container & container) noexcept :
+			data_{container.data()}, size_{container.size()} {
+	}
+
+	template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+	constexpr Span(Span<U> const & other) noexcept :
+			data_{other.data()}, size_{other.size()} {
+	}
+
+	constexpr T * data() const noexcept {
+		return data_;
+	}
+
+	constexpr std::size_t size() const noexcept {
+		return size_;
+	}
+
+	constexpr bool empty() const noexcept {
+		return size_ == 0;
+	}
+
+	constexpr T * begin() const noexcept {
+		return data_;
+	}
+
+	constexpr T * end() const noexcept {
+		return data_ + size_;
+	}
+
+	constexpr T & operator[](std::size_t const index) const noexcept {
+		return data_[index];
+	}
+
+	constexpr Span subspan(std::size_t const offset, std::size_t const count) const {
+		if (offset + count > size_) {
+			throw std::invalid_argument{"Subspan outside of span"};
+		}
+		return {data_ + offset, count};
+	}
+};
+
+// Keeps a parameter out of template argument deduction, so that containers
+// convert to the Span the other arguments determine.
+template <typename T>
+struct NonDeducedType {
+	using type = T;
+};
+
+template <typename T>
+using NonDeduced = typename NonDeducedType<T>::type;
+
+
+#endif /* SPAN_H_ */
@@ -1,37 +1,76 @@
 #ifndef SPHERE_H_
 #define SPHERE_H_
 
+#include "BoundingBox.h"
 #include "Matrix.h"
 #include "Material.h"
 #include "Operators.h"
 #include "Point.h"
+#include "Transform.h"
 #include "Transformations.h"
 
+#include <cmath>
+
 
 namespace Shapes {
 
-struct Sphere : operators::equality_comparable<Sphere> {
+template <typename T>
+struct BasicSphere : operators::equality_comparable<BasicSphere<T>> {
 
-	constexpr explicit Sphere(Point const position = {}, Matrix<4, 4, double> const transform = identity<4>, Material const material = defaultMaterial) :
+	constexpr explicit BasicSphere(BasicPoint<T> const position = {}, BasicTransform<T> const transform = {}, BasicMaterial<T> const material = basicDefaultMaterial<T>) :
 			position{position}, transform{transform}, material{material}{}
 
-	Point const position;
-	Matrix<4, 4, double> const transform;
-	Material material;
+	BasicPoint<T> const position;
+	BasicTransform<T> transform;
+	BasicMaterial<T> material;
 
-	constexpr bool operator==(Sphere const & other) const {
+	constexpr bool operator==(BasicSphere const & other) const {
 		return position == other.position;
 	}
 };
 
-constexpr Direction normalAt(Sphere const & sphere, Point const point) {
-	auto const inverseTransform = inverse(sphere.transform);
-	auto const objectPoint =  inverseTransform * point;
-	auto const objectNormal = objectPoint - Point{0, 0, 0};
-	auto const worldNormal = transpose(inverseTransform) * objectNormal;
+using Sphere = BasicSphere<double>;
+using SphereF = BasicSphere<float>;
+
+// Center of the sphere in world space.
+template <typename T>
+constexpr BasicPoint<T> center(BasicSphere<T> const & sphere) {
+	return sphere.transform.matrix() * sphere.position;
+}
+
+template <typename T>
+constexpr BasicDirection<T> normalAt(BasicSphere<T> const & sphere, BasicPoint<T> const point) {
+	if (auto const radius = sphere.transform.similarityScale(); radius != T(0)) {
+		return (point - center(sphere)) * (T(1) / radius);
+	}
+	auto const objectPoint = sphere.transform.inverse() * point;
+	auto const objectNormal = objectPoint - sphere.position;
+	auto const worldNormal = sphere.transform.inverseTranspose() * objectNormal;
 	return normalize(worldNormal);
 }
 
+template <typename T>
+constexpr BasicBoundingBox<T> objectBounds(BasicSphere<T> const & sphere) {
+	constexpr BasicDirection<T> radius{T(1), T(1), T(1)};
+	return {sphere.position - radius, sphere.position + radius};
+}
+
+// The unit sphere maps to an ellipsoid whose half extent along world axis i
+// is the length of row i of the linear part, which is tighter than
+// transforming objectBounds when the sphere is rotated.
+template <typename T>
+constexpr BasicBoundingBox<T> bounds(BasicSphere<T> const & sphere) {
+	auto const & matrix = sphere.transform.matrix();
+	auto const & m = matrix.values;
+	auto const center = matrix * sphere.position;
+	BasicDirection<T> const halfExtent{
+		std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]),
+		std::sqrt(m[4] * m[4] + m[5] * m[5] + m[6] * m[6]),
+		std::sqrt(m[8] * m[8] + m[9] * m[9] + m[10] * m[10])
+	};
+	return {center - halfExtent, center + halfExtent};
+}
+
 }
 
 
@@ -0,0 +1,238 @@
+#ifndef SPHEREBATCH_H_
+#define SPHEREBATCH_H_
+
+#include "Direction.h"
+#include "Intersections.h"
+#include "Point.h"
+#include "Ray.h"
+#include "SimdLanes.h"
+#include "Span.h"
+#include "Sphere.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+
+// Spheres laid out to test one ray against kBlock of them per step, for
+// scenes of many small spheres such as particles, where the inner loop of
+// a render visits them all. Spheres under similarities keep their world
+// space center and squared radius. The others keep the top rows of their
+// inverse transform as well, with which each lane takes the ray to the
+// object space of its sphere. Both groups are padded to whole blocks with
+// spheres that no ray hits.
+template <typename T>
+class BasicSphereBatch {
+public:
+	static constexpr std::size_t kBlock{8};
+
+private:
+	// One array per coordinate, indexed by slot.
+	struct Slots {
+		std::vector<T> centerX{};
+		std::vector<T> centerY{};
+		std::vector<T> centerZ{};
+		std::vector<T> radiusSquared{};
+		std::array<std::vector<T>, 12> inverse{};
+
+		std::size_t size() const noexcept {
+			return centerX.size();
+		}
+
+		void push(BasicPoint<T> const & center, T const radiusSquared, std::array<T, 16> const * const inverse) {
+			centerX.push_back(center.x);
+			centerY.push_back(center.y);
+			centerZ.push_back(center.z);
+			this->radiusSquared.push_back(radiusSquared);
+			if (inverse) {
+				for (std::size_t index = 0; index < this->inverse.size(); ++index) {
+					this->inverse[index].push_back((*inverse)[index]);
+				}
+			}
+		}
+
+		// A negative squared radius makes the discriminant negative.
+		void pad(bool const objectSpace) {
+			static constexpr std::array<T, 16> identity{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+			while (size() % kBlock != 0) {
+				push({}, T(-1), objectSpace ? &identity : nullptr);
+			}
+		}
+	};
+
+	Slots world_{};
+	Slots object_{};
+	// ShapeIds of the slots of world_ followed by those of object_.
+	std::vector<std::uint32_t> shapes_{};
+	std::size_t size_{};
+
+	using Lanes = SimdLanes<T>;
+	using Register = typename Lanes::Register;
+	static constexpr std::size_t kChunks{kBlock / Lanes::kCount};
+
+	// Nearest time and first slot of the block it was found in, per lane
+	// of a block.
+	struct Best {
+		Register time[kChunks];
+		Register block[kChunks];
+	};
+
+	static Register dot(Register const ax, Register const ay, Register const az, Register const bx, Register const by, Register const bz) noexcept {
+		using L = Lanes;
+		return L::add(L::add(L::multiply(ax, bx), L::multiply(ay, by)), L::multiply(az, bz));
+	}
+
+	// Most spheres of a batch are missed by a ray. Skipping the square root
+	// and division for chunks whose lanes all pass their sphere at more than
+	// its radius gives back most of what the scalar early return in
+	// hitTime() saves.
+	static bool missesAll(Register const radiusSquared, Register const perpendicularSquared) noexcept {
+		return Lanes::bits(Lanes::lessEqual(perpendicularSquared, radiusSquared)) == 0;
+	}
+
+	// sphereQuadratic() in world space, with a the same for all lanes.
+	void nearestInWorldSpace(BasicRay<T> const & ray, Best & best) const noexcept {
+		using L = Lanes;
+		auto const a = ::dot(ray.direction, ray.direction);
+		auto const squaredLength = L::broadcast(a);
+		auto const inverseA = L::broadcast(T(1) / a);
+		auto const originX = L::broadcast(ray.origin.x);
+		auto const originY = L::broadcast(ray.origin.y);
+		auto const originZ = L::broadcast(ray.origin.z);
+		auto const directionX = L::broadcast(ray.direction.x);
+		auto const directionY = L::broadcast(ray.direction.y);
+		auto const directionZ = L::broadcast(ray.direction.z);
+		for (std::size_t block = 0; block < world_.size(); block += kBlock) {
+			auto const blockSlot = L::broadcast(static_cast<T>(block));
+			for (std::size_t chunk = 0; chunk < kChunks; ++chunk) {
+				auto const slot = block + chunk * Lanes::kCount;
+				auto const toRayX = L::subtract(originX, L::load(world_.centerX.data() + slot));
+				auto const toRayY = L::subtract(originY, L::load(world_.centerY.data() + slot));
+				auto const toRayZ = L::subtract(originZ, L::load(world_.centerZ.data() + slot));
+				auto const radiusSquared = L::load(world_.radiusSquared.data() + slot);
+				auto const halfB = dot(directionX, directionY, directionZ, toRayX, toRayY, toRayZ);
+				auto const c = L::subtract(dot(toRayX, toRayY, toRayZ, toRayX, toRayY, toRayZ), radiusSquared);
+				auto const along = L::multiply(halfB, inverseA);
+				auto const perpendicularX = L::subtract(toRayX, L::multiply(directionX, along));
+				auto const perpendicularY = L::subtract(toRayY, L::multiply(directionY, along));
+				auto const perpendicularZ = L::subtract(toRayZ, L::multiply(directionZ, along));
+				auto const perpendicularSquared = dot(perpendicularX, perpendicularY, perpendicularZ, perpendicularX, perpendicularY, perpendicularZ);
+				if (missesAll(radiusSquared, perpendicularSquared)) {
+					continue;
+				}
+				auto const hits = nearestRoot<L>(squaredLength, inverseA, halfB, c, radiusSquared, perpendicularSquared, best.time[chunk], best.time[chunk]);
+				best.block[chunk] = L::select(hits, blockSlot, best.block[chunk]);
+			}
+		}
+	}
+
+	// sphereQuadratic() in the object space of each lane's sphere.
+	void nearestInObjectSpace(BasicRay<T> const & ray, Best & best) const noexcept {
+		using L = Lanes;
+		auto const originX = L::broadcast(ray.origin.x);
+		auto const originY = L::broadcast(ray.origin.y);
+		auto const originZ = L::broadcast(ray.origin.z);
+		auto const directionX = L::broadcast(ray.direction.x);
+		auto const directionY = L::broadcast(ray.direction.y);
+		auto const directionZ = L::broadcast(ray.direction.z);
+		auto const one = L::broadcast(T(1));
+		for (std::size_t block = 0; block < object_.size(); block += kBlock) {
+			auto const blockSlot = L::broadcast(static_cast<T>(world_.size() + block));
+			for (std::size_t chunk = 0; chunk < kChunks; ++chunk) {
+				auto const slot = block + chunk * Lanes::kCount;
+				auto const m = [&](std::size_t const index) {
+					return L::load(object_.inverse[index].data() + slot);
+				};
+				auto const localDirectionX = dot(m(0), m(1), m(2), directionX, directionY, directionZ);
+				auto const localDirectionY = dot(m(4), m(5), m(6), directionX, directionY, directionZ);
+				auto const localDirectionZ = dot(m(8), m(9), m(10), directionX, directionY, directionZ);
+				auto const toRayX = L::subtract(L::add(dot(m(0), m(1), m(2), originX, originY, originZ), m(3)), L::load(object_.centerX.data() + slot));
+				auto const toRayY = L::subtract(L::add(dot(m(4), m(5), m(6), originX, originY, originZ), m(7)), L::load(object_.centerY.data() + slot));
+				auto const toRayZ = L::subtract(L::add(dot(m(8), m(9), m(10), originX, originY, originZ), m(11)), L::load(object_.centerZ.data() + slot));
+				auto const radiusSquared = L::load(object_.radiusSquared.data() + slot);
+				auto const a = dot(localDirectionX, localDirectionY, localDirectionZ, localDirectionX, localDirectionY, localDirectionZ);
+				auto const inverseA = L::divide(one, a);
+				auto const halfB = dot(localDirectionX, localDirectionY, localDirectionZ, toRayX, toRayY, toRayZ);
+				auto const c = L::subtract(dot(toRayX, toRayY, toRayZ, toRayX, toRayY, toRayZ), radiusSquared);
+				auto const along = L::multiply(halfB, inverseA);
+				auto const perpendicularX = L::subtract(toRayX, L::multiply(localDirectionX, along));
+				auto const perpendicularY = L::subtract(toRayY, L::multiply(localDirectionY, along));
+				auto const perpendicularZ = L::subtract(toRayZ, L::multiply(localDirectionZ, along));
+				auto const perpendicularSquared = dot(perpendicularX, perpendicularY, perpendicularZ, perpendicularX, perpendicularY, perpendicularZ);
+				if (missesAll(radiusSquared, perpendicularSquared)) {
+					continue;
+				}
+				auto const hits = nearestRoot<L>(a, inverseA, halfB, c, radiusSquared, perpendicularSquared, best.time[chunk], best.time[chunk]);
+				best.block[chunk] = L::select(hits, blockSlot, best.block[chunk]);
+			}
+		}
+	}
+
+public:
+	BasicSphereBatch() = default;
+
+	// Slots are numbered with T in the kernel, so a batch of floats holds
+	// fewer spheres than a batch of doubles.
+	explicit BasicSphereBatch(Span<Shapes::BasicSphere<T> const> const spheres) : size_{spheres.size()} {
+		constexpr auto maximumSlots = std::numeric_limits<T>::digits < 32 ? (std::uint64_t{1} << std::numeric_limits<T>::digits) - 2 * kBlock : std::uint64_t{std::numeric_limits<std::uint32_t>::max()};
+		if (spheres.size() > maximumSlots) {
+			throw std::invalid_argument{"Batch cannot hold more spheres"};
+		}
+		std::vector<std::uint32_t> objectShapes{};
+		for (std::uint32_t shape = 0; shape < spheres.size(); ++shape) {
+			auto const & sphere = spheres[shape];
+			if (auto const radius = sphere.transform.similarityScale(); radius != T(0)) {
+				world_.push(Shapes::center(sphere), radius * radius, nullptr);
+				shapes_.push_back(shape);
+			} else {
+				object_.push(sphere.position, T(1), &sphere.transform.inverse().values);
+				objectShapes.push_back(shape);
+			}
+		}
+		world_.pad(false);
+		object_.pad(true);
+		shapes_.resize(world_.size(), std::numeric_limits<std::uint32_t>::max());
+		shapes_.insert(end(shapes_), begin(objectShapes), end(objectShapes));
+	}
+
+	std::size_t size() const noexcept {
+		return size_;
+	}
+
+	// Nearest sphere ray hits at a time in [0, tMax), as World::hit() over
+	// the same spheres without an accelerator.
+	std::optional<BasicIntersection<T>> hit(BasicRay<T> const & ray, T const tMax = std::numeric_limits<T>::infinity()) const noexcept {
+		using L = Lanes;
+		Best best{};
+		for (std::size_t chunk = 0; chunk < kChunks; ++chunk) {
+			best.time[chunk] = L::broadcast(tMax);
+			best.block[chunk] = L::broadcast(T(-1));
+		}
+		nearestInWorldSpace(ray, best);
+		nearestInObjectSpace(ray, best);
+		std::array<T, kBlock> times{};
+		std::array<T, kBlock> blocks{};
+		for (std::size_t chunk = 0; chunk < kChunks; ++chunk) {
+			L::store(times.data() + chunk * Lanes::kCount, best.time[chunk]);
+			L::store(blocks.data() + chunk * Lanes::kCount, best.block[chunk]);
+		}
+		std::optional<BasicIntersection<T>> closest{};
+		for (std::size_t lane = 0; lane < kBlock; ++lane) {
+			if (blocks[lane] >= T(0) && (!closest || times[lane] < closest->time)) {
+				auto const slot = static_cast<std::size_t>(blocks[lane]) + lane;
+				closest = BasicIntersection<T>{times[lane], ShapeId{shapes_[slot]}};
+			}
+		}
+		return closest;
+	}
+};
+
+using SphereBatch = BasicSphereBatch<double>;
+using SphereBatchF = BasicSphereBatch<float>;
+
+
+#endif /* SPHEREBATCH_H_ */
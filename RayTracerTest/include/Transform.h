@@ -0,0 +1,112 @@
+#ifndef TRANSFORM_H_
+#define TRANSFORM_H_
+
+#include "Matrix.h"
+#include "Operators.h"
+
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+
+template <typename T>
+class BasicTransform : operators::equality_comparable<BasicTransform<T>> {
+	Matrix<4, 4, T> matrix_;
+	bool invertible_;
+	Matrix<4, 4, T> inverse_;
+	Matrix<4, 4, T> inverseTranspose_;
+	T similarityScale_;
+
+	constexpr void checkInvertible() const {
+		if (!invertible_) {
+			throw std::invalid_argument{"Inverse of matrix with determinant zero is not computable"};
+		}
+	}
+
+	// The columns of the linear part of a similarity are orthogonal and of
+	// equal length, up to rounding of the factors it was composed from.
+	static constexpr T similarityScaleOf(Matrix<4, 4, T> const & matrix) {
+		auto const & m = matrix.values;
+		if (m[12] != T(0) || m[13] != T(0) || m[14] != T(0) || m[15] != T(1)) {
+			return T(0);
+		}
+		T products[3][3]{};
+		for (auto first = 0u; first < 3; ++first) {
+			for (auto second = 0u; second < 3; ++second) {
+				products[first][second] = m[first] * m[second] + m[4 + first] * m[4 + second] + m[8 + first] * m[8 + second];
+			}
+		}
+		auto const squared = products[0][0];
+		auto const tolerance = T(16) * std::numeric_limits<T>::epsilon() * squared;
+		for (auto first = 0u; first < 3; ++first) {
+			for (auto second = 0u; second < 3; ++second) {
+				auto const expected = first == second ? squared : T(0);
+				auto const difference = products[first][second] - expected;
+				if (difference > tolerance || -difference > tolerance) {
+					return T(0);
+				}
+			}
+		}
+		return squared > T(0) ? std::sqrt(squared) : T(0);
+	}
+
+public:
+
+	constexpr BasicTransform(Matrix<4, 4, T> const & matrix = identity<4, T>) :
+			matrix_{matrix},
+			invertible_{::invertible(matrix)},
+			inverse_{invertible_ ? ::inverse(matrix) : Matrix<4, 4, T>{}},
+			inverseTranspose_{transpose(inverse_)},
+			similarityScale_{similarityScaleOf(matrix)} {
+	}
+
+	// For callers that already know the inverse, e.g. a Transforms::Chain.
+	constexpr BasicTransform(Matrix<4, 4, T> const & matrix, Matrix<4, 4, T> const & inverse) :
+			matrix_{matrix},
+			invertible_{true},
+			inverse_{inverse},
+			inverseTranspose_{transpose(inverse_)},
+			similarityScale_{similarityScaleOf(matrix)} {
+	}
+
+	constexpr Matrix<4, 4, T> const & matrix() const noexcept {
+		return matrix_;
+	}
+
+	constexpr bool invertible() const noexcept {
+		return invertible_;
+	}
+
+	constexpr Matrix<4, 4, T> const & inverse() const {
+		checkInvertible();
+		return inverse_;
+	}
+
+	constexpr Matrix<4, 4, T> const & inverseTranspose() const {
+		checkInvertible();
+		return inverseTranspose_;
+	}
+
+	// The uniform scale factor if the transform is a similarity, that is a
+	// rotation or reflection, a uniform scaling and a translation, otherwise
+	// 0. A sphere under a similarity stays a sphere in world space.
+	constexpr T similarityScale() const noexcept {
+		return similarityScale_;
+	}
+
+	constexpr bool operator==(BasicTransform const & other) const {
+		return matrix_ == other.matrix_;
+	}
+};
+
+using Transform = BasicTransform<double>;
+using TransformF = BasicTransform<float>;
+
+template <typename T>
+std::ostream & operator<<(std::ostream & out, BasicTransform<T> const & transform) {
+	return out << "Transform " << transform.matrix();
+}
+
+
+#endif /* TRANSFORM_H_ */
@@ -0,0 +1,268 @@
+#ifndef TRANSFORMCHAIN_H_
+#define TRANSFORMCHAIN_H_
+
+#include "AffineTransform.h"
+#include "Direction.h"
+#include "DoubleComparison.h"
+#include "Matrix.h"
+#include "Point.h"
+#include "Transform.h"
+#include "Transformations.h"
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+// Lazily composed transformations: a Chain records primitive steps and only
+// folds them into a matrix when asked. Every primitive knows its inverse, so
+// the inverse of a chain never needs a general matrix inversion.
+namespace Transforms {
+
+template <typename T>
+struct Translation {
+	using ValueType = T;
+	T x, y, z;
+
+	constexpr Translation inverted() const {
+		return {-x, -y, -z};
+	}
+
+	constexpr BasicPoint<T> operator()(BasicPoint<T> const & point) const {
+		return {point.x + x, point.y + y, point.z + z};
+	}
+
+	constexpr BasicDirection<T> operator()(BasicDirection<T> const & direction) const {
+		return direction;
+	}
+};
+
+template <typename T>
+struct Scaling {
+	using ValueType = T;
+	T x, y, z;
+
+	constexpr Scaling inverted() const {
+		if (isEqual(x, T(0)) || isEqual(y, T(0)) || isEqual(z, T(0))) {
+			throw std::invalid_argument{"Inverse of matrix with determinant zero is not computable"};
+		}
+		return {T(1) / x, T(1) / y, T(1) / z};
+	}
+
+	template <typename Target>
+	constexpr Target operator()(Target const & target) const {
+		return {target.x * x, target.y * y, target.z * z};
+	}
+};
+
+template <typename T>
+struct RotationX {
+	using ValueType = T;
+	T cosine, sine;
+
+	constexpr RotationX inverted() const {
+		return {cosine, -sine};
+	}
+
+	template <typename Target>
+	constexpr Target operator()(Target const & target) const {
+		return {target.x, cosine * target.y - sine * target.z, sine * target.y + cosine * target.z};
+	}
+};
+
+template <typename T>
+struct RotationY {
+	using ValueType = T;
+	T cosine, sine;
+
+	constexpr RotationY inverted() const {
+		return {cosine, -sine};
+	}
+
+	template <typename Target>
+	constexpr Target operator()(Target const & target) const {
+		return {cosine * target.x + sine * target.z, target.y, cosine * target.z - sine * target.x};
+	}
+};
+
+template <typename T>
+struct RotationZ {
+	using ValueType = T;
+	T cosine, sine;
+
+	constexpr RotationZ inverted() const {
+		return {cosine, -sine};
+	}
+
+	template <typename Target>
+	constexpr Target operator()(Target const & target) const {
+		return {cosine * target.x - sine * target.y, sine * target.x + cosine * target.y, target.z};
+	}
+};
+
+template <typename T>
+struct Linear {
+	using ValueType = T;
+	Matrix<3, 3, T> matrix;
+
+	constexpr Linear inverted() const {
+		return {::inverse(matrix)};
+	}
+
+	template <typename Target>
+	constexpr Target operator()(Target const & target) const {
+		auto const & m = matrix.values;
+		return {
+			m[0] * target.x + m[1] * target.y + m[2] * target.z,
+			m[3] * target.x + m[4] * target.y + m[5] * target.z,
+			m[6] * target.x + m[7] * target.y + m[8] * target.z
+		};
+	}
+};
+
+template <typename T>
+struct Shearing {
+	using ValueType = T;
+	T xToY, xToZ, yToX, yToZ, zToX, zToY;
+
+	constexpr Linear<T> inverted() const {
+		return Linear<T>{Matrix<3, 3, T>{
+			T(1), xToY, xToZ,
+			yToX, T(1), yToZ,
+			zToX, zToY, T(1)
+		}}.inverted();
+	}
+
+	template <typename Target>
+	constexpr Target operator()(Target const & target) const {
+		return {
+			target.x + xToY * target.y + xToZ * target.z,
+			yToX * target.x + target.y + yToZ * target.z,
+			zToX * target.x + zToY * target.y + target.z
+		};
+	}
+};
+
+template <typename Step, typename Target>
+constexpr Target applyStep(Step const & step, Target const & target) {
+	return step(target);
+}
+
+// Left-multiplies by a step without a matrix product: the step maps the
+// linear columns as directions and the translation column as a point.
+template <typename Step, typename T>
+constexpr BasicAffineTransform<T> applyStep(Step const & step, BasicAffineTransform<T> const & transform) {
+	auto const & m = transform.matrix.values;
+	auto const x = step(BasicDirection<T>{m[0], m[4], m[8]});
+	auto const y = step(BasicDirection<T>{m[1], m[5], m[9]});
+	auto const z = step(BasicDirection<T>{m[2], m[6], m[10]});
+	auto const t = step(BasicPoint<T>{m[3], m[7], m[11]});
+	return BasicAffineTransform<T>{Matrix<3, 4, T>{
+		x.x, y.x, z.x, t.x,
+		x.y, y.y, z.y, t.y,
+		x.z, y.z, z.z, t.z
+	}};
+}
+
+template <typename...Steps>
+struct Chain {
+	using ValueType = typename std::tuple_element_t<0, std::tuple<Steps...>>::ValueType;
+	static_assert((std::is_same_v<ValueType, typename Steps::ValueType> && ...), "All steps of a chain must share the scalar type");
+
+	std::tuple<Steps...> steps;
+
+	constexpr BasicAffineTransform<ValueType> affine() const {
+		return apply(BasicAffineTransform<ValueType>{});
+	}
+
+	constexpr BasicAffineTransform<ValueType> inverseAffine() const {
+		return std::apply([](auto const &...step) {
+			BasicAffineTransform<ValueType> result{};
+			((result = applyStep(step.inverted(), result)), ...);
+			return result;
+		}, steps);
+	}
+
+	constexpr Matrix<4, 4, ValueType> matrix() const {
+		return affine().toMatrix();
+	}
+
+	constexpr Matrix<4, 4, ValueType> inverse() const {
+		return inverseAffine().toMatrix();
+	}
+
+	template <typename Target>
+	constexpr Target apply(Target const & target) const {
+		return applyInReverse(target, std::index_sequence_for<Steps...>{});
+	}
+
+	constexpr operator BasicTransform<ValueType>() const {
+		return {matrix(), inverse()};
+	}
+
+private:
+	template <typename Target, std::size_t...Index>
+	constexpr Target applyInReverse(Target target, std::index_sequence<Index...>) const {
+		((target = applyStep(std::get<sizeof...(Steps) - 1 - Index>(steps), target)), ...);
+		return target;
+	}
+};
+
+template <typename...Lhs, typename...Rhs>
+constexpr Chain<Lhs..., Rhs...> operator*(Chain<Lhs...> const & lhs, Chain<Rhs...> const & rhs) {
+	return {std::tuple_cat(lhs.steps, rhs.steps)};
+}
+
+template <typename...Steps>
+constexpr auto operator*(Chain<Steps...> const & chain, BasicPoint<typename Chain<Steps...>::ValueType> const & point) {
+	return chain.apply(point);
+}
+
+template <typename...Steps>
+constexpr auto operator*(Chain<Steps...> const & chain, BasicDirection<typename Chain<Steps...>::ValueType> const & direction) {
+	return chain.apply(direction);
+}
+
+template <typename T>
+constexpr auto translation(T const & x, T const & y, T const & z) {
+	using Scalar = TransformationScalar<T>;
+	return Chain<Translation<Scalar>>{{{Scalar(x), Scalar(y), Scalar(z)}}};
+}
+
+template <typename T>
+constexpr auto scaling(T const & x, T const & y, T const & z) {
+	using Scalar = TransformationScalar<T>;
+	return Chain<Scaling<Scalar>>{{{Scalar(x), Scalar(y), Scalar(z)}}};
+}
+
+template <typename T>
+constexpr auto rotation_x(T const & x) {
+	using Scalar = TransformationScalar<T>;
+	return Chain<RotationX<Scalar>>{{{std::cos(Scalar(x)), std::sin(Scalar(x))}}};
+}
+
+template <typename T>
+constexpr auto rotation_y(T const & x) {
+	using Scalar = TransformationScalar<T>;
+	return Chain<RotationY<Scalar>>{{{std::cos(Scalar(x)), std::sin(Scalar(x))}}};
+}
+
+template <typename T>
+constexpr auto rotation_z(T const & x) {
+	using Scalar = TransformationScalar<T>;
+	return Chain<RotationZ<Scalar>>{{{std::cos(Scalar(x)), std::sin(Scalar(x))}}};
+}
+
+template <typename T>
+constexpr auto shearing(T const & xToY, T const & xToZ, T const & yToX, T const & yToZ, T const & zToX, T const & zToY) {
+	using Scalar = TransformationScalar<T>;
+	return Chain<Shearing<Scalar>>{{{Scalar(xToY), Scalar(xToZ), Scalar(yToX), Scalar(yToZ), Scalar(zToX), Scalar(zToY)}}};
+}
+
+}
+
+
+#endif /* TRANSFORMCHAIN_H_ */
@@ -4,13 +4,18 @@
 
 #include "Matrix.h"
 #include "Point.h"
-#include "Ray.h"
 
 #include <cmath>
+#include <type_traits>
+
+// Integral arguments, as in translation(3, 4, 5), build double matrices.
+template <typename T>
+using TransformationScalar = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
 
 template <typename T>
 constexpr auto translation(T const & x, T const & y, T const & z) {
-	auto result = identity<4>;
+	auto result = identity<4, TransformationScalar<T>>;
 	result[0_row, 3_column] = x;
 	result[1_row, 3_column] = y;
 	result[2_row, 3_column] = z;
@@ -18,31 +23,31 @@ constexpr auto translation(T const & x, T const & y, T const & z) {
 }
 namespace {
 
-template <typename ValueType, typename Target>
-constexpr Target multiply(Matrix<4, 4, ValueType> const & transformation, Target const & target) {
-	auto const transformed = transformation * asMatrix(target);
+template <typename ValueType, typename Access, typename Target>
+constexpr Target multiply(Matrix<4, 4, ValueType, Access> const & transformation, Target const & target, ValueType const w) {
+	auto const & m = transformation.values;
 	return {
-			transformed[0_row, 0_column],
-			transformed[1_row, 0_column],
-			transformed[2_row, 0_column]
+			m[0] * target.x + m[1] * target.y + m[2] * target.z + m[3] * w,
+			m[4] * target.x + m[5] * target.y + m[6] * target.z + m[7] * w,
+			m[8] * target.x + m[9] * target.y + m[10] * target.z + m[11] * w
 		};
 }
 
 }
 
-template <typename ValueType>
-constexpr Point operator*(Matrix<4, 4, ValueType> const & transformation, Point const & point) {
-	return multiply(transformation, point);
+template <typename ValueType, typename Access>
+constexpr BasicPoint<ValueType> operator*(Matrix<4, 4, ValueType, Access> const & transformation, BasicPoint<ValueType> const & point) {
+	return multiply(transformation, point, ValueType{1});
 }
 
-template <typename ValueType>
-constexpr Direction operator*(Matrix<4, 4, ValueType> const & transformation, Direction const & direction) {
-	return multiply(transformation, direction);
+template <typename ValueType, typename Access>
+constexpr BasicDirection<ValueType> operator*(Matrix<4, 4, ValueType, Access> const & transformation, BasicDirection<ValueType> const & direction) {
+	return multiply(transformation, direction, ValueType{0});
 }
 
 template <typename T>
 constexpr auto scaling(T const & x, T const & y, T const & z) {
-	auto result = identity<4>;
+	auto result = identity<4, TransformationScalar<T>>;
 	result[0_row, 0_column] = x;
 	result[1_row, 1_column] = y;
 	result[2_row, 2_column] = z;
@@ -52,7 +57,7 @@ constexpr auto scaling(T const & x, T const & y, T const & z) {
 
 template <typename T>
 constexpr auto rotation_x(T const & x) {
-	auto rotation = identity<4>;
+	auto rotation = identity<4, TransformationScalar<T>>;
 	rotation[1_row, 1_column] = rotation[2_row, 2_column] = std::cos(x);
 	rotation[1_row, 2_column] = -std::sin(x);
 	rotation[2_row, 1_column] = std::sin(x);
@@ -61,7 +66,7 @@ constexpr auto rotation_x(T const & x) {
 
 template <typename T>
 constexpr auto rotation_y(T const & x) {
-	auto rotation = identity<4>;
+	auto rotation = identity<4, TransformationScalar<T>>;
 	rotation[0_row, 0_column] = rotation[2_row, 2_column] = std::cos(x);
 	rotation[0_row, 2_column] = std::sin(x);
 	rotation[2_row, 0_column] = -std::sin(x);
@@ -70,7 +75,7 @@ constexpr auto rotation_y(T const & x) {
 
 template <typename T>
 constexpr auto rotation_z(T const & x) {
-	auto rotation = identity<4>;
+	auto rotation = identity<4, TransformationScalar<T>>;
 	rotation[0_row, 0_column] = rotation[1_row, 1_column] = std::cos(x);
 	rotation[0_row, 1_column] = -std::sin(x);
 	rotation[1_row, 0_column] = std::sin(x);
@@ -79,7 +84,7 @@ constexpr auto rotation_z(T const & x) {
 
 template <typename T>
 constexpr auto shearing(T const & xToY, T const & xToZ, T const & yToX, T const & yToZ, T const & zToX, T const & zToY) {
-	auto shear = identity<4>;
+	auto shear = identity<4, TransformationScalar<T>>;
 	shear[0_row, 1_column] = xToY;
 	shear[0_row, 2_column] = xToZ;
 	shear[1_row, 0_column] = yToX;
@@ -0,0 +1,310 @@
+#ifndef WORLD_H_
+#define WORLD_H_
+
+#include "BoundingBox.h"
+#include "Bvh.h"
+#include "Bvh4.h"
+#include "Grid.h"
+#include "Intersections.h"
+#include "Light.h"
+#include "Occlusion.h"
+#include "Ray.h"
+#include "Scene.h"
+#include "Sphere.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+
+// Shapes and lights of a scene. Intersection queries test every shape
+// unless one of the accelerators was built: buildBvh(), buildBvh4() or
+// buildGrid(). Building one discards the others.
+template <typename T>
+class BasicWorld {
+	BasicScene<T> scene_{};
+	std::vector<BasicLight<T>> lights_{};
+	BasicBvh<T> bvh_{};
+	// Collapsed from bvh_ and sharing its primitive order when built.
+	BasicBvh4<T> bvh4_{};
+	BasicGrid<T> grid_{};
+	// Copies of the spheres in the leaf order of bvh_, so a leaf reads a
+	// contiguous range instead of gathering by shape id.
+	std::vector<Shapes::BasicSphere<T>> bvhSpheres_{};
+	// The primitive of each shape in bvh_, and the primitives of shapes
+	// whose transform changed since the hierarchy was last refitted.
+	std::vector<std::uint32_t> primitives_{};
+	std::vector<std::uint32_t> moved_{};
+
+	void discardAccelerators() {
+		bvh_ = {};
+		bvh4_ = {};
+		grid_ = {};
+		bvhSpheres_.clear();
+		primitives_.clear();
+		moved_.clear();
+	}
+
+	void gatherPrimitives() {
+		bvhSpheres_.clear();
+		bvhSpheres_.reserve(bvh_.size());
+		primitives_.resize(bvh_.size());
+		for (std::uint32_t primitive = 0; primitive < bvh_.size(); ++primitive) {
+			auto const shape = bvh_.shapes()[primitive];
+			bvhSpheres_.push_back(scene_.spheres()[shape]);
+			primitives_[shape] = primitive;
+		}
+	}
+
+	// Calls visit(sphere, id, bounds, tMax) for each shape the active
+	// accelerator cannot rule out, under the contract of BasicBvh::traverse.
+	template <typename Visitor>
+	BvhTraversalCounters forEachCandidate(BasicPrecomputedRay<T> const & ray, Visitor && visit) const {
+		if (hasGrid()) {
+			return grid_.traverse(ray, [&](std::uint32_t const shape, T const tMax) {
+				return visit(scene_.spheres()[shape], ShapeId{shape}, scene_.bounds(ShapeId{shape}), tMax);
+			});
+		}
+		if (hasBvh()) {
+			auto const visitPrimitive = [&](std::uint32_t const primitive, T const tMax) {
+				return visit(bvhSpheres_[primitive], ShapeId{bvh_.shapes()[primitive]}, bvh_.primitiveBounds(primitive), tMax);
+			};
+			return hasBvh4() ? bvh4_.traverse(ray, visitPrimitive) : bvh_.traverse(ray, visitPrimitive);
+		}
+		BvhTraversalCounters counters{};
+		auto tMax = ray.tMax;
+		for (std::uint32_t shape = 0; shape < scene_.size() && tMax >= ray.tMin; ++shape) {
+			++counters.primitivesVisited;
+			tMax = visit(scene_.spheres()[shape], ShapeId{shape}, scene_.bounds(ShapeId{shape}), tMax);
+		}
+		return counters;
+	}
+
+	static void append(BasicIntersectionResult<T> const & result, BasicIntersectionBuffer<T> & buffer) {
+		for (std::size_t hit = 0; hit < result.count; ++hit) {
+			buffer.push_back(result.times[hit]);
+		}
+	}
+
+	// Closest hit at a time in [0, tMax) among the intersections of sphere.
+	static T closer(Shapes::BasicSphere<T> const & sphere, ShapeId const id, BasicRay<T> const & ray, T const tMax, std::optional<BasicIntersection<T>> & closest) {
+		auto const time = hitTime(sphere, ray, tMax);
+		if (!time) {
+			return tMax;
+		}
+		closest = BasicIntersection<T>{*time, id};
+		return *time;
+	}
+
+public:
+	// Adding a shape discards the accelerators until one is built again.
+	ShapeId add(Shapes::BasicSphere<T> const & sphere) {
+		discardAccelerators();
+		return scene_.add(sphere);
+	}
+
+	void add(BasicLight<T> const & light) {
+		lights_.push_back(light);
+	}
+
+	BasicScene<T> const & scene() const noexcept {
+		return scene_;
+	}
+
+	std::vector<BasicLight<T>> const & lights() const noexcept {
+		return lights_;
+	}
+
+	// Builds the hierarchy with up to threads threads and returns its build statistics.
+	BasicBvhBuildStatistics<T> buildBvh(std::size_t const threads = 1) {
+		discardAccelerators();
+		bvh_ = BasicBvh<T>{scene_.bounds(), threads};
+		gatherPrimitives();
+		return bvh_.statistics();
+	}
+
+	// Builds the binary hierarchy and traverses the four-wide one collapsed from it.
+	BasicBvhBuildStatistics<T> buildBvh4(std::size_t const threads = 1) {
+		auto const statistics = buildBvh(threads);
+		bvh4_ = BasicBvh4<T>{bvh_};
+		return statistics;
+	}
+
+	// Builds a uniform grid, whose resolution follows from the number of
+	// shapes and their bounds.
+	void buildGrid() {
+		discardAccelerators();
+		grid_ = BasicGrid<T>{scene_.bounds()};
+	}
+
+	// Moves a shape. Until refitBvh() brings the hierarchy up to date,
+	// intersection queries test every shape. A grid is discarded; it is
+	// cheap to build again.
+	void setTransform(ShapeId const id, BasicTransform<T> const & transform) {
+		scene_.setTransform(id, transform);
+		grid_ = {};
+		if (bvh_.size() == scene_.size()) {
+			auto const primitive = primitives_[id.value];
+			bvhSpheres_[primitive].transform = transform;
+			moved_.push_back(primitive);
+		}
+	}
+
+	// Refits the hierarchy to the shapes moved since the last refit, in time
+	// proportional to their number. If that raises the SAH cost by more than
+	// maximumDegradation over the last build, the subtrees that grew by as
+	// much are rebuilt.
+	BasicBvhRefitStatistics<T> refitBvh(T const maximumDegradation = T(1.5)) {
+		BasicBvhRefitStatistics<T> statistics{};
+		if (!moved_.empty()) {
+			auto const refitted = bvh_.refit(moved_, scene_.bounds());
+			auto const wide = bvh4_.size() == bvh_.size();
+			if (wide) {
+				bvh4_.refit(bvh_, refitted, moved_);
+			}
+			moved_.clear();
+			statistics.nodesRefitted = refitted.size();
+			if (bvh_.sahCost() > maximumDegradation * bvh_.referenceSahCost()) {
+				statistics.primitivesRebuilt = bvh_.rebuild(scene_.bounds(), maximumDegradation);
+				gatherPrimitives();
+				if (wide) {
+					bvh4_ = BasicBvh4<T>{bvh_};
+				}
+			}
+		}
+		statistics.sahCost = bvh_.sahCost();
+		return statistics;
+	}
+
+	// Whether intersection queries use a hierarchy instead of testing every shape.
+	bool hasBvh() const noexcept {
+		return bvh_.size() != 0 && bvh_.size() == scene_.size() && moved_.empty();
+	}
+
+	bool hasBvh4() const noexcept {
+		return hasBvh() && bvh4_.size() == bvh_.size();
+	}
+
+	bool hasGrid() const noexcept {
+		return grid_.size() != 0 && grid_.size() == scene_.size();
+	}
+
+	BasicBvh<T> const & bvh() const noexcept {
+		return bvh_;
+	}
+
+	BasicBvh4<T> const & bvh4() const noexcept {
+		return bvh4_;
+	}
+
+	BasicGrid<T> const & grid() const noexcept {
+		return grid_;
+	}
+
+	// Replaces the contents of buffer with all intersections of ray, sorted by
+	// time. Reusing the buffer avoids allocating once it has grown large enough.
+	void intersect(BasicRay<T> const & ray, BasicIntersectionBuffer<T> & buffer) const {
+		constexpr auto kInfinity = std::numeric_limits<T>::infinity();
+		buffer.clear();
+		BasicPrecomputedRay<T> const precomputed{ray, -kInfinity, kInfinity};
+		// A grid visits a shape from every cell it spans; its intersections
+		// are appended only the first time. Comparing intersections instead
+		// would also merge the two equal times of a tangent ray.
+		// The mailbox is per thread, so concurrent queries do not share it
+		// and a thread allocates only when the scene outgrows it.
+		thread_local ShapeMailbox visited{};
+		auto const grid = hasGrid();
+		if (grid) {
+			visited.next(scene_.size());
+		}
+		forEachCandidate(precomputed, [&](Shapes::BasicSphere<T> const & sphere, ShapeId const id, BasicBoundingBox<T> const & bounds, T const tMax) {
+			if (grid && !visited.visit(id.value)) {
+				return tMax;
+			}
+			T entry{};
+			if (intersects(bounds, precomputed, entry)) {
+				append(::intersect(sphere, ray, id), buffer);
+			}
+			return tMax;
+		});
+		std::sort(buffer.begin(), buffer.end(), [](auto const & lhs, auto const & rhs) {
+			return lhs.time < rhs.time || (lhs.time == rhs.time && lhs.shape.value < rhs.shape.value);
+		});
+	}
+
+	BasicIntersectionBuffer<T> intersect(BasicRay<T> const & ray) const {
+		BasicIntersectionBuffer<T> buffer{};
+		intersect(ray, buffer);
+		return buffer;
+	}
+
+	// Nearest intersection at a non-negative time, pruning the accelerator
+	// beyond the closest hit found so far. counters accumulates the nodes and
+	// primitives the traversal visited.
+	std::optional<BasicIntersection<T>> hit(BasicRay<T> const & ray, BvhTraversalCounters & counters) const {
+		std::optional<BasicIntersection<T>> closest{};
+		BasicPrecomputedRay<T> const precomputed{ray};
+		counters += forEachCandidate(precomputed, [&](Shapes::BasicSphere<T> const & sphere, ShapeId const id, BasicBoundingBox<T> const & bounds, T const tMax) {
+			T entry{};
+			if (!intersects(bounds, precomputed, T(0), tMax, entry)) {
+				return tMax;
+			}
+			return closer(sphere, id, ray, tMax, closest);
+		});
+		return closest;
+	}
+
+	std::optional<BasicIntersection<T>> hit(BasicRay<T> const & ray) const {
+		BvhTraversalCounters counters{};
+		return hit(ray, counters);
+	}
+
+	// Whether ray hits any shape at a time in [0, maxTime); stops at the
+	// first such hit rather than looking for the nearest.
+	bool anyHit(BasicRay<T> const & ray, T const maxTime, BvhTraversalCounters & counters) const {
+		auto found = false;
+		BasicPrecomputedRay<T> const precomputed{ray, T(0), maxTime};
+		counters += forEachCandidate(precomputed, [&](Shapes::BasicSphere<T> const & sphere, ShapeId, BasicBoundingBox<T> const & bounds, T const tMax) {
+			T entry{};
+			if (!intersects(bounds, precomputed, T(0), tMax, entry)) {
+				return tMax;
+			}
+			if (blocks(sphere, ray, maxTime)) {
+				found = true;
+				return -std::numeric_limits<T>::infinity();
+			}
+			return tMax;
+		});
+		return found;
+	}
+
+	bool anyHit(BasicRay<T> const & ray, T const maxTime = std::numeric_limits<T>::infinity()) const {
+		BvhTraversalCounters counters{};
+		return anyHit(ray, maxTime, counters);
+	}
+
+	// Whether a shape lies between point and light, as isOccluded() over
+	// all shapes but using the active accelerator.
+	bool isOccluded(BasicPoint<T> const & point, BasicLight<T> const & light, OcclusionCounters & counters) const {
+		BvhTraversalCounters traversal{};
+		auto const occluded = anyHit(shadowRay(point, light), T(1), traversal);
+		++counters.queries;
+		counters.occluded += occluded;
+		counters.nodesVisited += traversal.nodesVisited;
+		counters.shapesTested += traversal.primitivesVisited;
+		return occluded;
+	}
+
+	bool isOccluded(BasicPoint<T> const & point, BasicLight<T> const & light) const {
+		OcclusionCounters counters{};
+		return isOccluded(point, light, counters);
+	}
+};
+
+using World = BasicWorld<double>;
+using WorldF = BasicWorld<float>;
+
+
+#endif /* WORLD_H_ */
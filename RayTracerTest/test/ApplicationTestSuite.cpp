@@ -4,12 +4,18 @@
 #include "Direction.h"
 #include "Intersections.h"
 #include "Light.h"
+#include "Occlusion.h"
 #include "Pi.h"
 #include "Point.h"
+#include "RayPacket.h"
+#include "Scene.h"
 #include "Sphere.h"
+#include "TransformChain.h"
 #include "Transformations.h"
 #include "cute.h"
 
+#include <array>
+#include <cstddef>
 #include <vector>
 #include <fstream>
 #include <string>
@@ -23,21 +29,21 @@ struct Projectile {
 	Direction velocity;
 };
 
-struct World {
+struct Environment {
 	Direction const gravity;
 	Direction const wind;
 };
 
-Projectile tick(World const & world, Projectile const & projectile) {
+Projectile tick(Environment const & environment, Projectile const & projectile) {
 	return {
 		projectile.location + projectile.velocity,
-		projectile.velocity + world.gravity + world.wind
+		projectile.velocity + environment.gravity + environment.wind
 	};
 }
 
 void testProjectileTrajectory() {
 	Projectile projectile{{0.0, 1.0, 0.0}, normalize({1.0, 1.0, 0.0})};
-	constexpr World world{{0.0, -0.1, 0.0}, {-0.01, 0.0, 0.0}};
+	constexpr Environment environment{{0.0, -0.1, 0.0}, {-0.01, 0.0, 0.0}};
 
 	std::vector<Point> const expected{
 		{0.0, 1.0, 0.0},
@@ -62,7 +68,7 @@ void testProjectileTrajectory() {
 
 	do {
 		trajectory.push_back(projectile.location);
-		projectile = tick(world, projectile);
+		projectile = tick(environment, projectile);
 	} while (projectile.location.y > 0.0);
 
 	ASSERT_EQUAL(expected, trajectory);
@@ -75,11 +81,11 @@ void testProjectileTraceOnCanvas() {
 	Projectile projectile{startingPoint, projectileVelocity};
 	constexpr Direction gravity{0.0, -0.1, 0.0};
 	constexpr Direction wind{-0.01, 0, 0};
-	constexpr World world{gravity, wind};
+	constexpr Environment environment{gravity, wind};
 	Canvas traceCanvas{900_column, 550_row};
 	do {
 		traceCanvas[projectile.location] = projectileColor;
-		projectile = tick(world, projectile);
+		projectile = tick(environment, projectile);
 	} while(projectile.location.y > 0.0);
 
 	std::ofstream outputFile{outputDirectory + "projectile.ppm"};
@@ -92,10 +98,8 @@ void testClockWithRotation() {
 	constexpr Point startingPoint{0.0, 1.0, 0.0};
 	Canvas clockCanvas{300_column, 300_row};
 	for (auto angle = 0.0; angle < 2 * pi<double>; angle += 2 * pi<double> / 12) {
-		auto const scaledPoint = scaling(0.0, 100.0, 0.0) * startingPoint;
-		auto const rotatedPoint = rotation_z(angle) * scaledPoint;
-		auto const translatedPoint = translation(150.0, 150.0, 0.0) * rotatedPoint;
-		clockCanvas[translatedPoint] = clockDotColor;
+		auto const clockHand = Transforms::translation(150.0, 150.0, 0.0) * Transforms::rotation_z(angle) * Transforms::scaling(0.0, 100.0, 0.0);
+		clockCanvas[clockHand * startingPoint] = clockDotColor;
 	}
 	std::ofstream outputFile{outputDirectory + "clock.ppm"};
 	printPPM(outputFile, clockCanvas);
@@ -136,23 +140,45 @@ void testRayHitsSphereCanvasWithLighting() {
 	constexpr Light lightSource{{-10.0, -10.0, -10.0}, Colors::white};
 	constexpr Material sphereMaterial = [newMaterial = defaultMaterial]()mutable{newMaterial.color = {1.0, 0.2, 1.0}; return newMaterial;}();
 	constexpr Shapes::Sphere sphere{Point{0.0, 0.0, 0.0}, scaling(1.0, 1.0, 1.0), sphereMaterial};
+	Scene scene{};
+	scene.add(sphere);
 	constexpr Point startingPoint{0.0, 0.0, -5.0};
+	// Shadow rays start this far off the surface so that it does not shadow itself.
+	constexpr double shadowBias{1e-9};
+	// Eight neighbouring pixels of a row are traced as one packet, first
+	// from the eye and then from their hits to the light.
+	constexpr std::size_t packetWidth{RayPacket8::kWidth};
+	static_assert(canvasWidth.value % packetWidth == 0);
+	std::array<double, packetWidth> toLight{};
+	toLight.fill(1.0);
 	Canvas lightCanvas{canvasWidth, canvasHeight};
 	for (auto row = 0_row; row < lightCanvas.rows(); row++) {
-		for (auto col = 0_column; col < lightCanvas.columns(); col++) {
-			double const columnOffset = col.value;
-			double const rowOffset = row.value;
-			Point const canvasPoint = canvasTopLeft + columnOffset * canvasPixelWidth + rowOffset * canvasPixelHeight;
-			Ray const ray{startingPoint, normalize(canvasPoint - startingPoint)};
-			auto const result = intersect(sphere, ray);
-			auto const firstHit = hit(result.times, result.count);
-			if (firstHit) {
-				auto const hitPosition = ray.position(firstHit->time);
-				auto const hitSphere = std::get<Shapes::Sphere>(firstHit->object);
-				auto const normal = normalAt(hitSphere, hitPosition);
-				auto const eye = -ray.direction;
-				auto const reflectionColor = lighting(hitSphere.material, lightSource, hitPosition, eye, normal);
-				lightCanvas[col, row] = reflectionColor;
+		for (auto col = 0_column; col < lightCanvas.columns(); col += Column{packetWidth}) {
+			RayPacket8 primary{};
+			for (std::size_t lane = 0; lane < packetWidth; ++lane) {
+				double const columnOffset = (col + Column{lane}).value;
+				double const rowOffset = row.value;
+				Point const canvasPoint = canvasTopLeft + columnOffset * canvasPixelWidth + rowOffset * canvasPixelHeight;
+				primary.set(lane, Ray{startingPoint, normalize(canvasPoint - startingPoint)});
+			}
+			auto const hits = hit(scene.spheres(), primary);
+			std::array<Point, packetWidth> hitPositions{};
+			std::array<Direction, packetWidth> normals{};
+			RayPacket8 shadow{};
+			for (std::size_t lane = 0; lane < packetWidth; ++lane) {
+				if (hits.mask & (1u << lane)) {
+					hitPositions[lane] = primary[lane].position(hits.time[lane]);
+					normals[lane] = normalAt(scene[hits.shape[lane]], hitPositions[lane]);
+					shadow.set(lane, shadowRay(hitPositions[lane] + normals[lane] * shadowBias, lightSource));
+				}
+			}
+			auto const inShadow = occluded(scene.spheres(), shadow, toLight, hits.mask);
+			for (std::size_t lane = 0; lane < packetWidth; ++lane) {
+				if (hits.mask & (1u << lane)) {
+					auto const eye = -primary[lane].direction;
+					auto const reflectionColor = lighting(scene[hits.shape[lane]].material, lightSource, hitPositions[lane], eye, normals[lane], (inShadow & (1u << lane)) != 0);
+					lightCanvas[col + Column{lane}, row] = reflectionColor;
+				}
 			}
 		}
 	}
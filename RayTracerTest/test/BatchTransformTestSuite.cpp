@@ -0,0 +1,148 @@
+#include "BatchTransformTestSuite.h"
+#include "BatchTransform.h"
+#include "Direction.h"
+#include "MatrixKernels.h"
+#include "Pi.h"
+#include "Point.h"
+#include "Transformations.h"
+#include "cute.h"
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+auto const batchMatrix = translation(5.0, -3.0, 2.0) * rotation_y(pi<double> / 7) * scaling(2.0, 0.5, 4.0);
+
+std::vector<Point> batchPoints(std::size_t const count) {
+	std::vector<Point> points{};
+	for (std::size_t index = 0; index < count; ++index) {
+		auto const value = static_cast<double>(index);
+		points.push_back(Point{value, 0.5 * value - 3.0, 7.0 - value});
+	}
+	return points;
+}
+
+}
+
+void testTransformPointsMatchesPerPointProduct() {
+	auto const points = batchPoints(5);
+	std::vector<Point> transformed(points.size());
+	transformPoints(batchMatrix, points, transformed);
+	for (std::size_t index = 0; index < points.size(); ++index) {
+		ASSERT_EQUAL(batchMatrix * points[index], transformed[index]);
+	}
+}
+
+void testTransformDirectionsIgnoresTranslation() {
+	std::array<Direction, 2> const directions{Direction{1.0, 0.0, 0.0}, Direction{0.0, 2.0, 0.0}};
+	std::array<Direction, 2> transformed{};
+	transformDirections(translation(5.0, 6.0, 7.0), directions, transformed);
+	ASSERT_EQUAL(directions, transformed);
+}
+
+void testTransformPointsAtCompileTime() {
+	constexpr auto transformed = [] {
+		std::array<Point, 2> const points{Point{1.0, 2.0, 3.0}, Point{-1.0, 0.0, 1.0}};
+		std::array<Point, 2> result{};
+		transformPoints(translation(1.0, 1.0, 1.0), points, result);
+		return result;
+	}();
+	ASSERT_EQUAL((Point{2.0, 3.0, 4.0}), transformed[0]);
+	ASSERT_EQUAL((Point{0.0, 1.0, 2.0}), transformed[1]);
+}
+
+void testTransformPointsWithMismatchingSizesThrows() {
+	auto const points = batchPoints(3);
+	std::vector<Point> transformed(2);
+	ASSERT_THROWS(transformPoints(batchMatrix, points, transformed), std::invalid_argument);
+}
+
+void testCoordinateSpansWithMismatchingSizesThrows() {
+	std::vector<double> x(3), y(3), z(2);
+	ASSERT_THROWS((CoordinateSpans<double>{x, y, z}), std::invalid_argument);
+}
+
+void testSoATransformMatchesPerPointProduct() {
+	auto const points = batchPoints(37);
+	CoordinateArrays<double> const in{points};
+	CoordinateArrays<double> out{points.size()};
+	transformPoints(batchMatrix, in.spans(), out.spans());
+	for (std::size_t index = 0; index < points.size(); ++index) {
+		ASSERT_EQUAL(batchMatrix * points[index], (Point{out.x[index], out.y[index], out.z[index]}));
+	}
+}
+
+void testSoATransformDirectionsInPlace() {
+	std::vector<Direction> const directions{Direction{1.0, 2.0, 3.0}, Direction{-4.0, 0.5, 2.0}, Direction{0.0, 0.0, 1.0}};
+	CoordinateArrays<double> arrays{directions};
+	transformDirections(batchMatrix, arrays.spans(), arrays.spans());
+	for (std::size_t index = 0; index < directions.size(); ++index) {
+		ASSERT_EQUAL(batchMatrix * directions[index], (Direction{arrays.x[index], arrays.y[index], arrays.z[index]}));
+	}
+}
+
+void testParallelSoATransformMatchesSequential() {
+	auto const points = batchPoints(50000);
+	CoordinateArrays<double> const in{points};
+	CoordinateArrays<double> sequential{points.size()};
+	CoordinateArrays<double> parallel{points.size()};
+	transformPoints(batchMatrix, in.spans(), sequential.spans());
+	transformPoints(batchMatrix, in.spans(), parallel.spans(), 4);
+	ASSERT_EQUAL(sequential.x, parallel.x);
+	ASSERT_EQUAL(sequential.y, parallel.y);
+	ASSERT_EQUAL(sequential.z, parallel.z);
+}
+
+void testSinglePrecisionSoATransform() {
+	auto const matrix = translation(1.0f, 2.0f, 3.0f) * scaling(2.0f, 2.0f, 2.0f);
+	std::vector<PointF> const points{PointF{1.0f, 1.0f, 1.0f}, PointF{-1.0f, 0.0f, 0.5f}};
+	CoordinateArrays<float> const in{points};
+	CoordinateArrays<float> out{points.size()};
+	transformPoints(matrix, in.spans(), out.spans());
+	for (std::size_t index = 0; index < points.size(); ++index) {
+		ASSERT_EQUAL(matrix * points[index], (PointF{out.x[index], out.y[index], out.z[index]}));
+	}
+}
+
+void testTransformKernelsMatchScalarKernel() {
+	auto const points = batchPoints(11);
+	CoordinateArrays<double> const in{points};
+	CoordinateArrays<double> expected{points.size()};
+	kernels::scalar.transform(batchMatrix.values.data(), 1.0, in.x.data(), in.y.data(), in.z.data(), expected.x.data(), expected.y.data(), expected.z.data(), in.size());
+	std::vector<kernels::KernelTable> tables{};
+#ifdef RAYTRACER_X86_KERNELS
+	tables.push_back(kernels::sse2);
+	if (kernels::supported(kernels::avx2)) {
+		tables.push_back(kernels::avx2);
+	}
+#endif
+	for (auto const & table : tables) {
+		CoordinateArrays<double> result{points.size()};
+		table.transform(batchMatrix.values.data(), 1.0, in.x.data(), in.y.data(), in.z.data(), result.x.data(), result.y.data(), result.z.data(), in.size());
+		for (std::size_t index = 0; index < in.size(); ++index) {
+			ASSERT_EQUAL_DELTAM(table.name, expected.x[index], result.x[index], 1e-12);
+			ASSERT_EQUAL_DELTAM(table.name, expected.y[index], result.y[index], 1e-12);
+			ASSERT_EQUAL_DELTAM(table.name, expected.z[index], result.z[index], 1e-12);
+		}
+	}
+}
+
+cute::suite make_suite_BatchTransformTestSuite() {
+	cute::suite s { };
+	s.push_back(CUTE(testTransformPointsMatchesPerPointProduct));
+	s.push_back(CUTE(testTransformDirectionsIgnoresTranslation));
+	s.push_back(CUTE(testTransformPointsAtCompileTime));
+	s.push_back(CUTE(testTransformPointsWithMismatchingSizesThrows));
+	s.push_back(CUTE(testCoordinateSpansWithMismatchingSizesThrows));
+	s.push_back(CUTE(testSoATransformMatchesPerPointProduct));
+	s.push_back(CUTE(testSoATransformDirectionsInPlace));
+	s.push_back(CUTE(testParallelSoATransformMatchesSequential));
+	s.push_back(CUTE(testSinglePrecisionSoATransform));
+	s.push_back(CUTE(testTransformKernelsMatchScalarKernel));
+	return s;
+}
@@ -0,0 +1,8 @@
+#ifndef BATCHTRANSFORMTESTSUITE_H_
+#define BATCHTRANSFORMTESTSUITE_H_
+
+#include "cute_suite.h"
+
+extern cute::suite make_suite_BatchTransformTestSuite();
+
+#endif /* BATCHTRANSFORMTESTSUITE_H_ */
@@ -0,0 +1,34 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+
+template <typename T>
+inline void doNotOptimize(T const & value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "g"(&value) : "memory");
+#else
+	static_cast<void>(*reinterpret_cast<char const volatile *>(&value));
+#endif
+}
+
+template <typename Operation>
+double nanosecondsPerOperation(std::size_t const iterations, Operation && operation) {
+	auto const start = std::chrono::steady_clock::now();
+	for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+		operation(iteration);
+	}
+	auto const duration = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double, std::nano>(duration).count() / iterations;
+}
+
+inline std::ofstream benchmarkReport(std::string const & name) {
+	return std::ofstream{"TestResults/" + name + ".txt"};
+}
+
+
+#endif /* BENCHMARK_H_ */
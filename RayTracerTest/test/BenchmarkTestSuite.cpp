@@ -0,0 +1,572 @@
+#include "BenchmarkTestSuite.h"
+#include "Benchmark.h"
+#include "BatchTransform.h"
+#include "BoundingBox.h"
+#include "Bvh.h"
+#include "Color.h"
+#include "Instancing.h"
+#include "Intersections.h"
+#include "Light.h"
+#include "Matrix.h"
+#include "Occlusion.h"
+#include "Pi.h"
+#include "Point.h"
+#include "RandomScenes.h"
+#include "Ray.h"
+#include "RayPacket.h"
+#include "Sphere.h"
+#include "SphereBatch.h"
+#include "TransformChain.h"
+#include "Transformations.h"
+#include "World.h"
+#include "cute.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <chrono>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+constexpr std::size_t kIterations{200000};
+
+template <typename Access>
+constexpr Matrix<4, 4, double, Access> benchmarkMatrix {
+	 3.0, -9.0,  7.0,  3.0,
+	 3.0, -8.0,  2.0, -9.0,
+	-4.0,  4.0,  4.0,  1.0,
+	-6.0,  5.0, -1.0,  1.0
+};
+
+template <typename Access>
+Matrix<4, 4, double, Access> perturbed(std::size_t const iteration) {
+	auto matrix = benchmarkMatrix<Access>;
+	matrix[0_row, 0_column] += static_cast<double>(iteration % 7);
+	return matrix;
+}
+
+template <typename Access>
+double elementSumNanoseconds() {
+	return nanosecondsPerOperation(kIterations, [](std::size_t iteration) {
+		auto const matrix = perturbed<Access>(iteration);
+		double sum{};
+		for (auto row = 0_row; row < 4_row; ++row) {
+			for (auto column = 0_column; column < 4_column; ++column) {
+				sum += matrix[row, column];
+			}
+		}
+		doNotOptimize(sum);
+	});
+}
+
+template <typename Access>
+double compileTimeIndexNanoseconds() {
+	return nanosecondsPerOperation(kIterations, [](std::size_t iteration) {
+		auto const matrix = perturbed<Access>(iteration);
+		auto const trace = matrix.template get<0, 0>() + matrix.template get<1, 1>() + matrix.template get<2, 2>() + matrix.template get<3, 3>();
+		doNotOptimize(trace);
+	});
+}
+
+template <typename Access>
+double transposeNanoseconds() {
+	return nanosecondsPerOperation(kIterations, [](std::size_t iteration) {
+		auto const transposed = transpose(perturbed<Access>(iteration));
+		doNotOptimize(transposed);
+	});
+}
+
+template <typename Access>
+double genericProductNanoseconds() {
+	return nanosecondsPerOperation(kIterations, [](std::size_t iteration) {
+		auto const product = operator*<4, 4, 4, double, Access>(perturbed<Access>(iteration), benchmarkMatrix<Access>);
+		doNotOptimize(product);
+	});
+}
+
+template <typename Access>
+double cofactorInverseNanoseconds() {
+	return nanosecondsPerOperation(kIterations / 10, [](std::size_t iteration) {
+		auto const inverted = cofactorInverse(perturbed<Access>(iteration));
+		doNotOptimize(inverted);
+	});
+}
+
+template <typename Measurement>
+void reportAccessPolicies(std::ostream & out, char const * operation, Measurement && measure) {
+	out << operation << ": checked " << measure(CheckedAccess{}) << " ns/op, unchecked " << measure(UncheckedAccess{}) << " ns/op\n";
+}
+
+double angleFor(std::size_t const iteration) {
+	return static_cast<double>(iteration % 12) * pi<double> / 6;
+}
+
+// Spheres of radius 0.5 on a square grid in the z = 0 plane, one unit apart.
+World gridWorld(std::size_t const objects) {
+	World world{};
+	auto const side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(objects))));
+	for (std::size_t index = 0; index < objects; ++index) {
+		auto const x = static_cast<double>(index % side);
+		auto const y = static_cast<double>(index / side);
+		world.add(Shapes::Sphere{{}, Transforms::translation(x, y, 0.0) * Transforms::scaling(0.5, 0.5, 0.5)});
+	}
+	return world;
+}
+
+// Spheres with radii between 0.05 and 0.5 in a cube whose volume grows
+// with their number.
+World benchmarkWorld(std::size_t const objects) {
+	return randomSphereWorld(objects, 42, 2.0 * std::cbrt(static_cast<double>(objects)), 0.05, 0.5);
+}
+
+// The eye rays of the lit sphere of ApplicationTestSuite, on a coarser canvas.
+std::vector<Ray> litSphereRays(std::size_t const side) {
+	constexpr Point eye{0.0, 0.0, -5.0};
+	std::vector<Ray> rays{};
+	for (std::size_t row = 0; row < side; ++row) {
+		for (std::size_t column = 0; column < side; ++column) {
+			Point const canvasPoint{-3.0 + 6.0 * column / side, -3.0 + 6.0 * row / side, 0.0};
+			rays.push_back(Ray{eye, normalize(canvasPoint - eye)});
+		}
+	}
+	return rays;
+}
+
+template <typename T, std::size_t N>
+std::vector<BasicRayPacket<T, N>> packetsOf(std::vector<Ray> const & rays) {
+	std::vector<BasicRayPacket<T, N>> packets(rays.size() / N);
+	for (std::size_t index = 0; index < packets.size() * N; ++index) {
+		auto const & ray = rays[index];
+		packets[index / N].set(index % N, BasicRay<T>{
+			{static_cast<T>(ray.origin.x), static_cast<T>(ray.origin.y), static_cast<T>(ray.origin.z)},
+			{static_cast<T>(ray.direction.x), static_cast<T>(ray.direction.y), static_cast<T>(ray.direction.z)}});
+	}
+	return packets;
+}
+
+template <typename T, std::size_t N>
+double packetHitNanoseconds(std::vector<Ray> const & rays) {
+	std::vector<Shapes::BasicSphere<T>> const spheres{Shapes::BasicSphere<T>{}};
+	auto const packets = packetsOf<T, N>(rays);
+	return nanosecondsPerOperation(packets.size(), [&](std::size_t iteration) {
+		doNotOptimize(hit(spheres, packets[iteration]));
+	}) / N;
+}
+
+Ray gridRay(std::size_t const iteration, std::size_t const objects) {
+	auto const side = std::sqrt(static_cast<double>(objects));
+	auto const offset = static_cast<double>(iteration % 97) / 97.0;
+	return Ray{{offset * side, (1.0 - offset) * side, -10.0}, normalize(Direction{0.01, -0.01, 1.0})};
+}
+
+}
+
+void benchmarkMatrixAccessPolicies() {
+	auto report = benchmarkReport("matrixAccessPolicies");
+	reportAccessPolicies(report, "element sum", [](auto access) {
+		return elementSumNanoseconds<decltype(access)>();
+	});
+	reportAccessPolicies(report, "get<Row, Column> trace", [](auto access) {
+		return compileTimeIndexNanoseconds<decltype(access)>();
+	});
+	reportAccessPolicies(report, "transpose", [](auto access) {
+		return transposeNanoseconds<decltype(access)>();
+	});
+	reportAccessPolicies(report, "generic product", [](auto access) {
+		return genericProductNanoseconds<decltype(access)>();
+	});
+	reportAccessPolicies(report, "cofactor inverse", [](auto access) {
+		return cofactorInverseNanoseconds<decltype(access)>();
+	});
+	ASSERT_EQUAL(cofactorInverse(benchmarkMatrix<CheckedAccess>).values, cofactorInverse(benchmarkMatrix<UncheckedAccess>).values);
+	ASSERT(report);
+}
+
+void benchmarkTransformChain() {
+	constexpr Point point{0.0, 1.0, 0.0};
+	auto report = benchmarkReport("transformChain");
+	report << "apply to point: eager "
+			<< nanosecondsPerOperation(kIterations, [&](std::size_t iteration) {
+				auto const transformed = translation(150.0, 150.0, 0.0) * (rotation_z(angleFor(iteration)) * (scaling(2.0, 100.0, 2.0) * point));
+				doNotOptimize(transformed);
+			}) << " ns/op, chain "
+			<< nanosecondsPerOperation(kIterations, [&](std::size_t iteration) {
+				auto const chain = Transforms::translation(150.0, 150.0, 0.0) * Transforms::rotation_z(angleFor(iteration)) * Transforms::scaling(2.0, 100.0, 2.0);
+				doNotOptimize(chain * point);
+			}) << " ns/op\n";
+	report << "matrix and inverse: eager "
+			<< nanosecondsPerOperation(kIterations, [](std::size_t iteration) {
+				auto const matrix = translation(150.0, 150.0, 0.0) * rotation_z(angleFor(iteration)) * scaling(2.0, 100.0, 2.0);
+				auto const inverted = inverse(matrix);
+				doNotOptimize(inverted);
+			}) << " ns/op, chain "
+			<< nanosecondsPerOperation(kIterations, [](std::size_t iteration) {
+				auto const chain = Transforms::translation(150.0, 150.0, 0.0) * Transforms::rotation_z(angleFor(iteration)) * Transforms::scaling(2.0, 100.0, 2.0);
+				auto const matrix = chain.matrix();
+				auto const inverted = chain.inverse();
+				doNotOptimize(matrix);
+				doNotOptimize(inverted);
+			}) << " ns/op\n";
+	ASSERT(report);
+}
+
+void benchmarkBatchTransform() {
+	constexpr std::size_t kPoints{1 << 20};
+	constexpr std::size_t kRepetitions{8};
+	auto const matrix = translation(5.0, -3.0, 2.0) * rotation_y(pi<double> / 7) * scaling(2.0, 0.5, 4.0);
+	std::vector<Point> points(kPoints);
+	for (std::size_t index = 0; index < kPoints; ++index) {
+		auto const value = static_cast<double>(index);
+		points[index] = Point{value, -value, 0.5 * value};
+	}
+	std::vector<Point> transformed(kPoints);
+	CoordinateArrays<double> const in{points};
+	CoordinateArrays<double> out{kPoints};
+	auto const threads = std::max(1u, std::thread::hardware_concurrency());
+	auto report = benchmarkReport("batchTransform");
+	report << "points per batch: " << kPoints << ", threads: " << threads << '\n';
+	report << "scalar loop: " << nanosecondsPerOperation(kRepetitions, [&](std::size_t) {
+		for (std::size_t index = 0; index < kPoints; ++index) {
+			transformed[index] = matrix * points[index];
+		}
+		doNotOptimize(transformed.data());
+	}) / kPoints << " ns/point\n";
+	report << "transformPoints AoS: " << nanosecondsPerOperation(kRepetitions, [&](std::size_t) {
+		transformPoints(matrix, points, transformed);
+		doNotOptimize(transformed.data());
+	}) / kPoints << " ns/point\n";
+	report << "transformPoints SoA (" << kernels::active().name << "): " << nanosecondsPerOperation(kRepetitions, [&](std::size_t) {
+		transformPoints(matrix, in.spans(), out.spans());
+		doNotOptimize(out.x.data());
+	}) / kPoints << " ns/point\n";
+	report << "transformPoints SoA parallel: " << nanosecondsPerOperation(kRepetitions, [&](std::size_t) {
+		transformPoints(matrix, in.spans(), out.spans(), threads);
+		doNotOptimize(out.x.data());
+	}) / kPoints << " ns/point\n";
+	ASSERT_EQUAL(transformed.back(), (Point{out.x.back(), out.y.back(), out.z.back()}));
+	ASSERT(report);
+}
+
+void benchmarkWorldIntersection() {
+	constexpr std::size_t kSphereTests{2000000};
+	auto report = benchmarkReport("worldIntersection");
+	IntersectionBuffer buffer{};
+	for (std::size_t objects = 1; objects <= 100000; objects *= 10) {
+		auto const world = gridWorld(objects);
+		auto const rays = std::max<std::size_t>(32, kSphereTests / objects);
+		auto const nanoseconds = nanosecondsPerOperation(rays, [&](std::size_t iteration) {
+			world.intersect(gridRay(iteration, objects), buffer);
+			doNotOptimize(buffer.data());
+		});
+		report << objects << " objects: " << nanoseconds << " ns/ray, " << nanoseconds / objects << " ns/object\n";
+	}
+	ASSERT(report);
+}
+
+void benchmarkBvh() {
+	constexpr std::size_t kObjects{100000};
+	auto world = benchmarkWorld(kObjects);
+	auto const side = 2.0 * std::cbrt(static_cast<double>(kObjects));
+	auto const rays = randomRays(1024, 7, side, -2.0 * side);
+	auto report = benchmarkReport("bvh");
+	report << kObjects << " random spheres\n";
+	auto const linearHit = nanosecondsPerOperation(16, [&](std::size_t iteration) {
+		doNotOptimize(world.hit(rays[iteration]));
+	});
+	auto const start = std::chrono::steady_clock::now();
+	world.buildBvh();
+	auto const buildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	report << "build: " << buildTime << " ms, " << world.bvh().nodeCount() << " nodes\n";
+	IntersectionBuffer buffer{};
+	std::size_t hits{};
+	auto const bvhHit = nanosecondsPerOperation(rays.size(), [&](std::size_t iteration) {
+		auto const result = world.hit(rays[iteration]);
+		hits += result.has_value();
+		doNotOptimize(result);
+	});
+	auto const bvhIntersect = nanosecondsPerOperation(rays.size(), [&](std::size_t iteration) {
+		world.intersect(rays[iteration], buffer);
+		doNotOptimize(buffer.data());
+	});
+	BvhTraversalCounters counters{};
+	for (auto const & ray : rays) {
+		world.hit(ray, counters);
+	}
+	report << "hit: linear " << linearHit << " ns/ray, bvh " << bvhHit << " ns/ray (" << hits << " of " << rays.size() << " rays hit)\n";
+	report << "hit traversal: " << double(counters.nodesVisited) / rays.size() << " nodes/ray, " << double(counters.primitivesVisited) / rays.size() << " primitives/ray\n";
+	report << "all intersections: bvh " << bvhIntersect << " ns/ray\n";
+	world.buildBvh4();
+	auto const bvh4Hit = nanosecondsPerOperation(rays.size(), [&](std::size_t iteration) {
+		doNotOptimize(world.hit(rays[iteration]));
+	});
+	BvhTraversalCounters wideCounters{};
+	for (auto const & ray : rays) {
+		world.hit(ray, wideCounters);
+	}
+	report << "bvh4: " << world.bvh4().nodeCount() << " nodes, hit " << bvh4Hit << " ns/ray, " << double(wideCounters.nodesVisited) / rays.size() << " nodes/ray, " << double(wideCounters.primitivesVisited) / rays.size() << " primitives/ray\n";
+	ASSERT(hits > 0);
+	ASSERT(report);
+}
+
+void benchmarkParallelBvhBuild() {
+	constexpr std::size_t kBoxes{1000000};
+	std::mt19937 generator{42};
+	std::uniform_real_distribution<double> position{-500.0, 500.0};
+	std::uniform_real_distribution<double> size{0.1, 2.0};
+	std::vector<BoundingBox> boxes{};
+	boxes.reserve(kBoxes);
+	for (std::size_t index = 0; index < kBoxes; ++index) {
+		Point const corner{position(generator), position(generator), position(generator)};
+		boxes.push_back({corner, corner + Direction{size(generator), size(generator), size(generator)}});
+	}
+	auto report = benchmarkReport("bvh_build");
+	report << kBoxes << " random boxes, " << std::thread::hardware_concurrency() << " hardware threads\n";
+	for (std::size_t const threads : {std::size_t{1}, std::size_t{2}, std::size_t{4}, std::size_t{8}}) {
+		Bvh const bvh{boxes, threads};
+		auto const & statistics = bvh.statistics();
+		report << threads << " threads: " << statistics.milliseconds << " ms, " << statistics.nodeCount << " nodes, SAH cost " << statistics.sahCost << '\n';
+	}
+	ASSERT(report);
+}
+
+void benchmarkBvhRefit() {
+	constexpr std::size_t kObjects{100000};
+	auto world = benchmarkWorld(kObjects);
+	auto report = benchmarkReport("bvh_refit");
+	auto const build = world.buildBvh();
+	report << kObjects << " random spheres, build " << build.milliseconds << " ms\n";
+	std::mt19937 generator{7};
+	std::uniform_real_distribution<double> offset{-0.05, 0.05};
+	for (std::size_t const moved : {std::size_t{10}, std::size_t{100}, std::size_t{1000}, std::size_t{10000}}) {
+		std::uniform_int_distribution<std::uint32_t> shape{0, kObjects - 1};
+		auto const start = std::chrono::steady_clock::now();
+		for (std::size_t index = 0; index < moved; ++index) {
+			ShapeId const id{shape(generator)};
+			world.setTransform(id, translation(offset(generator), offset(generator), offset(generator)) * world.scene()[id].transform.matrix());
+		}
+		auto const statistics = world.refitBvh();
+		auto const refitTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		report << moved << " moved: " << refitTime << " ms, " << statistics.nodesRefitted << " nodes refitted, " << statistics.primitivesRebuilt << " primitives rebuilt, SAH cost " << statistics.sahCost << " (built " << world.bvh().referenceSahCost() << ")\n";
+	}
+	ASSERT(world.hasBvh());
+	ASSERT(report);
+}
+
+void benchmarkGrid() {
+	constexpr std::size_t kObjects{100000};
+	auto world = benchmarkWorld(kObjects);
+	auto const side = 2.0 * std::cbrt(static_cast<double>(kObjects));
+	auto const rays = randomRays(1024, 7, side, -2.0 * side);
+	auto report = benchmarkReport("grid");
+	report << kObjects << " random spheres of similar size\n";
+	auto const bruteForce = nanosecondsPerOperation(16, [&](std::size_t iteration) {
+		std::optional<Intersection> closest{};
+		for (auto const & sphere : world.scene().spheres()) {
+			auto const result = intersect(sphere, rays[iteration]);
+			if (auto const candidate = hit(result.times, result.count); candidate && (!closest || candidate->time < closest->time)) {
+				closest = candidate;
+			}
+		}
+		doNotOptimize(closest);
+	});
+	auto const measure = [&](char const * name, double const buildTime) {
+		BvhTraversalCounters counters{};
+		for (auto const & ray : rays) {
+			world.hit(ray, counters);
+		}
+		auto const nearest = nanosecondsPerOperation(rays.size(), [&](std::size_t iteration) {
+			doNotOptimize(world.hit(rays[iteration]));
+		});
+		auto const any = nanosecondsPerOperation(rays.size(), [&](std::size_t iteration) {
+			doNotOptimize(world.anyHit(rays[iteration]));
+		});
+		report << name << ": build " << buildTime << " ms, hit " << nearest << " ns/ray, any hit " << any << " ns/ray, "
+				<< double(counters.nodesVisited) / rays.size() << " nodes/ray, " << double(counters.primitivesVisited) / rays.size() << " primitives/ray\n";
+	};
+	report << "brute force intersect(): " << bruteForce << " ns/ray\n";
+	auto start = std::chrono::steady_clock::now();
+	world.buildGrid();
+	auto const gridBuild = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	auto const & resolution = world.grid().resolution();
+	report << "grid resolution " << resolution[0] << 'x' << resolution[1] << 'x' << resolution[2] << '\n';
+	measure("grid", gridBuild);
+	measure("bvh4", world.buildBvh4().milliseconds);
+	ASSERT(world.hasBvh4());
+	ASSERT(report);
+}
+
+void benchmarkShadowRays() {
+	constexpr std::size_t kObjects{1000};
+	auto world = benchmarkWorld(kObjects);
+	auto const side = 2.0 * std::cbrt(static_cast<double>(kObjects));
+	Light const light{{0.0, 3.0 * side, 0.0}, Colors::white};
+	std::mt19937 generator{5};
+	std::uniform_real_distribution<double> coordinate{-side, side};
+	std::vector<Point> points{};
+	for (auto index = 0; index < 1024; ++index) {
+		points.push_back({coordinate(generator), coordinate(generator), coordinate(generator)});
+	}
+	IntersectionBuffer buffer{};
+	auto const nearest = nanosecondsPerOperation(points.size(), [&](std::size_t iteration) {
+		auto const ray = shadowRay(points[iteration], light);
+		world.intersect(ray, buffer);
+		auto const closest = hit(buffer);
+		doNotOptimize(closest && closest->time < 1.0);
+	});
+	OcclusionCounters linearCounters{};
+	auto const linear = nanosecondsPerOperation(points.size(), [&](std::size_t iteration) {
+		doNotOptimize(isOccluded(world.scene(), points[iteration], light, linearCounters));
+	});
+	world.buildBvh4();
+	OcclusionCounters counters{};
+	auto const accelerated = nanosecondsPerOperation(points.size(), [&](std::size_t iteration) {
+		doNotOptimize(world.isOccluded(points[iteration], light, counters));
+	});
+	auto report = benchmarkReport("shadow_rays");
+	report << kObjects << " random spheres, " << double(counters.occluded) / counters.queries << " of shadow rays occluded\n";
+	report << "intersect() and hit(): " << nearest << " ns/ray\n";
+	report << "isOccluded() over all shapes: " << linear << " ns/ray, " << double(linearCounters.shapesTested) / linearCounters.queries << " shapes/ray\n";
+	report << "isOccluded() with bvh4: " << accelerated << " ns/ray, " << double(counters.nodesVisited) / counters.queries << " nodes/ray, " << double(counters.shapesTested) / counters.queries << " shapes/ray\n";
+	ASSERT(report);
+}
+
+void benchmarkInstancing() {
+	constexpr std::size_t kShapes{32};
+	constexpr std::size_t kInstances{2000};
+	auto const shapes = benchmarkWorld(kShapes).scene().spheres();
+	std::mt19937 generator{11};
+	auto const side = 4.0 * std::cbrt(static_cast<double>(kShapes * kInstances));
+	std::uniform_real_distribution<double> coordinate{-side, side};
+	std::uniform_real_distribution<double> angle{0.0, 2.0 * pi<double>};
+	InstancedScene scene{};
+	auto const geometry = scene.add(Geometry{shapes});
+	World world{};
+	for (std::size_t instance = 0; instance < kInstances; ++instance) {
+		Transform const placement{translation(coordinate(generator), coordinate(generator), coordinate(generator)) * rotation_y(angle(generator))};
+		scene.add(Instance{geometry, placement, {}});
+		for (auto const & sphere : shapes) {
+			world.add(Shapes::Sphere{sphere.position, Transform{placement.matrix() * sphere.transform.matrix()}, sphere.material});
+		}
+	}
+	auto const instancedBuild = scene.buildBvh().milliseconds;
+	auto const flattenedBuild = world.buildBvh().milliseconds;
+	auto const & shared = scene.geometries().front();
+	auto const instancedBytes = shared.size() * sizeof(Shapes::Sphere) + shared.bvh().nodeCount() * sizeof(BvhNode) +
+			kInstances * (sizeof(Instance) + sizeof(BoundingBox)) + scene.bvh().nodeCount() * sizeof(BvhNode);
+	auto const flattenedBytes = world.scene().size() * (2 * sizeof(Shapes::Sphere) + sizeof(BoundingBox)) + world.bvh().nodeCount() * sizeof(BvhNode);
+	auto const rays = randomRays(1024, 7, side, -2.0 * side);
+	auto const instancedHit = nanosecondsPerOperation(rays.size(), [&](std::size_t iteration) {
+		doNotOptimize(scene.hit(rays[iteration]));
+	});
+	auto const flattenedHit = nanosecondsPerOperation(rays.size(), [&](std::size_t iteration) {
+		doNotOptimize(world.hit(rays[iteration]));
+	});
+	auto report = benchmarkReport("instancing");
+	report << kInstances << " instances of " << kShapes << " spheres\n";
+	report << "instanced: build " << instancedBuild << " ms, " << instancedBytes / 1024 << " KiB, hit " << instancedHit << " ns/ray\n";
+	report << "flattened: build " << flattenedBuild << " ms, " << flattenedBytes / 1024 << " KiB, hit " << flattenedHit << " ns/ray\n";
+	ASSERT(instancedBytes < flattenedBytes);
+	ASSERT(report);
+}
+
+void benchmarkRayPackets() {
+	constexpr std::size_t kSide{256};
+	constexpr Light light{{-10.0, -10.0, -10.0}, Colors::white};
+	std::vector<Shapes::Sphere> const spheres{Shapes::Sphere{}};
+	auto const rays = litSphereRays(kSide);
+	auto const scalar = nanosecondsPerOperation(rays.size(), [&](std::size_t iteration) {
+		auto const result = intersect(spheres.front(), rays[iteration]);
+		doNotOptimize(hit(result.times, result.count));
+	});
+	std::vector<Ray> shadowRays{};
+	for (auto const & ray : rays) {
+		if (auto const time = hitTime(spheres.front(), ray)) {
+			auto const point = ray.position(*time);
+			shadowRays.push_back(shadowRay(point + normalAt(spheres.front(), point) * 1e-9, light));
+		}
+	}
+	auto const scalarShadow = nanosecondsPerOperation(shadowRays.size(), [&](std::size_t iteration) {
+		doNotOptimize(blocks(spheres.front(), shadowRays[iteration], 1.0));
+	});
+	auto const shadowPackets = packetsOf<double, 8>(shadowRays);
+	std::array<double, 8> toLight{};
+	toLight.fill(1.0);
+	auto const packetShadow = nanosecondsPerOperation(shadowPackets.size(), [&](std::size_t iteration) {
+		doNotOptimize(occluded(spheres, shadowPackets[iteration], toLight));
+	}) / 8;
+	auto report = benchmarkReport("ray_packets");
+	report << kSide << "x" << kSide << " eye rays of the lit sphere, " << simdKernel << " packet kernel\n";
+	report << "intersect() and hit(): " << scalar << " ns/ray\n";
+	report << "packet of 4 doubles: " << packetHitNanoseconds<double, 4>(rays) << " ns/ray\n";
+	report << "packet of 8 doubles: " << packetHitNanoseconds<double, 8>(rays) << " ns/ray\n";
+	report << "packet of 4 floats: " << packetHitNanoseconds<float, 4>(rays) << " ns/ray\n";
+	report << "packet of 8 floats: " << packetHitNanoseconds<float, 8>(rays) << " ns/ray\n";
+	report << shadowRays.size() << " shadow rays: blocks() " << scalarShadow << " ns/ray, packet of 8 doubles " << packetShadow << " ns/ray\n";
+	ASSERT(report);
+}
+
+void benchmarkSphereBatch() {
+	constexpr std::size_t kParticles{2000};
+	auto world = benchmarkWorld(kParticles);
+	auto const & spheres = world.scene().spheres();
+	std::vector<Shapes::SphereF> floatSpheres{};
+	for (auto const & sphere : spheres) {
+		auto const center = Shapes::center(sphere);
+		auto const radius = static_cast<float>(sphere.transform.similarityScale());
+		floatSpheres.push_back(Shapes::SphereF{{}, TransformF{translation(static_cast<float>(center.x), static_cast<float>(center.y), static_cast<float>(center.z)) * scaling(radius, radius, radius)}});
+	}
+	SphereBatch const batch{spheres};
+	SphereBatchF const floatBatch{floatSpheres};
+	auto const side = 2.0 * std::cbrt(static_cast<double>(kParticles));
+	auto const rays = randomRays(1024, 7, side, -2.0 * side);
+	std::vector<RayF> floatRays{};
+	for (auto const & ray : rays) {
+		floatRays.push_back(RayF{
+			{static_cast<float>(ray.origin.x), static_cast<float>(ray.origin.y), static_cast<float>(ray.origin.z)},
+			{static_cast<float>(ray.direction.x), static_cast<float>(ray.direction.y), static_cast<float>(ray.direction.z)}});
+	}
+	auto const linear = nanosecondsPerOperation(rays.size(), [&](std::size_t iteration) {
+		doNotOptimize(world.hit(rays[iteration]));
+	});
+	auto const batched = nanosecondsPerOperation(rays.size(), [&](std::size_t iteration) {
+		doNotOptimize(batch.hit(rays[iteration]));
+	});
+	auto const floatBatched = nanosecondsPerOperation(floatRays.size(), [&](std::size_t iteration) {
+		doNotOptimize(floatBatch.hit(floatRays[iteration]));
+	});
+	world.buildBvh4();
+	auto const accelerated = nanosecondsPerOperation(rays.size(), [&](std::size_t iteration) {
+		doNotOptimize(world.hit(rays[iteration]));
+	});
+	auto report = benchmarkReport("sphere_batch");
+	report << kParticles << " random particles, " << simdKernel << " batch kernel, " << SphereBatch::kBlock << " spheres per step\n";
+	report << "hit() over all shapes: " << linear << " ns/ray\n";
+	report << "SphereBatch::hit(): " << batched << " ns/ray\n";
+	report << "SphereBatchF::hit(): " << floatBatched << " ns/ray\n";
+	report << "hit() with bvh4: " << accelerated << " ns/ray\n";
+	ASSERT(report);
+}
+
+cute::suite make_suite_BenchmarkTestSuite() {
+	cute::suite s { };
+	s.push_back(CUTE(benchmarkMatrixAccessPolicies));
+	s.push_back(CUTE(benchmarkTransformChain));
+	s.push_back(CUTE(benchmarkBatchTransform));
+	s.push_back(CUTE(benchmarkWorldIntersection));
+	s.push_back(CUTE(benchmarkBvh));
+	s.push_back(CUTE(benchmarkParallelBvhBuild));
+	s.push_back(CUTE(benchmarkBvhRefit));
+	s.push_back(CUTE(benchmarkGrid));
+	s.push_back(CUTE(benchmarkShadowRays));
+	s.push_back(CUTE(benchmarkInstancing));
+	s.push_back(CUTE(benchmarkRayPackets));
+	s.push_back(CUTE(benchmarkSphereBatch));
+	return s;
+}
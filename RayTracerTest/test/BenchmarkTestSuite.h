@@ -0,0 +1,8 @@
+#ifndef BENCHMARKTESTSUITE_H_
+#define BENCHMARKTESTSUITE_H_
+
+#include "cute_suite.h"
+
+extern cute::suite make_suite_BenchmarkTestSuite();
+
+#endif /* BENCHMARKTESTSUITE_H_ */
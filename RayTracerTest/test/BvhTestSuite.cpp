@@ -0,0 +1,540 @@
+#include "BvhTestSuite.h"
+#include "BoundingBox.h"
+#include "Bvh.h"
+#include "Bvh4.h"
+#include "Intersections.h"
+#include "Point.h"
+#include "RandomScenes.h"
+#include "Ray.h"
+#include "Scene.h"
+#include "Sphere.h"
+#include "TransformChain.h"
+#include "Transformations.h"
+#include "World.h"
+#include "cute.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using Shapes::Sphere;
+
+namespace {
+
+// Returns the index one past the subtree at index, which in depth first
+// order is where the next sibling starts; also returns the subtree depth.
+std::uint32_t checkNode(Bvh const & bvh, std::uint32_t const index, std::vector<int> & seen, std::size_t & depth) {
+	auto const & node = bvh.nodes()[index];
+	auto const bounds = node.bounds<double>();
+	if (node.leaf()) {
+		for (auto primitive = node.offset; primitive < node.offset + node.count; ++primitive) {
+			ASSERT(bounds.contains(bvh.primitiveBounds(primitive)));
+			++seen[bvh.shapes()[primitive]];
+		}
+		depth = 1;
+		return index + 1;
+	}
+	auto const left = index + 1;
+	ASSERT(bounds.contains(bvh.nodes()[left].bounds<double>()));
+	ASSERT(bounds.contains(bvh.nodes()[node.offset].bounds<double>()));
+	std::size_t leftDepth{};
+	std::size_t rightDepth{};
+	ASSERT_EQUAL(node.offset, checkNode(bvh, left, seen, leftDepth));
+	auto const end = checkNode(bvh, node.offset, seen, rightDepth);
+	depth = 1 + std::max(leftDepth, rightDepth);
+	return end;
+}
+
+void move(World & world, ShapeId const id, Direction const offset) {
+	world.setTransform(id, translation(offset.x, offset.y, offset.z) * world.scene()[id].transform.matrix());
+}
+
+// One past the last primitive below node.
+std::uint32_t primitiveEnd(Bvh const & bvh, std::uint32_t const node) {
+	auto const & current = bvh.nodes()[node];
+	return current.leaf() ? current.offset + current.count : primitiveEnd(bvh, current.offset);
+}
+
+void checkCoversEveryShapeOnce(Bvh const & bvh) {
+	std::vector<int> seen(bvh.size());
+	std::size_t depth{};
+	ASSERT_EQUAL(bvh.nodeCount(), checkNode(bvh, 0, seen, depth));
+	ASSERT_EQUAL(std::vector<int>(bvh.size(), 1), seen);
+}
+
+void checkNode4(Bvh4 const & bvh, std::uint32_t const index, std::vector<int> & seen) {
+	auto const & node = bvh.nodes()[index];
+	ASSERT(node.children > 0 && node.children <= Bvh4Node::kWidth);
+	for (std::size_t slot = 0; slot < node.children; ++slot) {
+		BoundingBox const bounds{
+				{node.min[0][slot], node.min[1][slot], node.min[2][slot]},
+				{node.max[0][slot], node.max[1][slot], node.max[2][slot]}};
+		if (node.count[slot] == 0) {
+			ASSERT(node.child[slot] > index);
+			checkNode4(bvh, node.child[slot], seen);
+			continue;
+		}
+		for (auto primitive = node.child[slot]; primitive < node.child[slot] + node.count[slot]; ++primitive) {
+			ASSERT(bounds.contains(bvh.primitiveBounds(primitive)));
+			++seen[bvh.shapes()[primitive]];
+		}
+	}
+}
+
+}
+
+void testDefaultBoundingBoxIsEmpty() {
+	constexpr BoundingBox box{};
+	ASSERT(box.empty());
+	ASSERT_EQUAL(0.0, box.surfaceArea());
+}
+
+void testBoundingBoxExtendsToPoints() {
+	constexpr auto box = BoundingBox{}.extend(Point{1.0, -2.0, 3.0}).extend(Point{-1.0, 2.0, 4.0});
+	ASSERT_EQUAL((Point{-1.0, -2.0, 3.0}), box.min);
+	ASSERT_EQUAL((Point{1.0, 2.0, 4.0}), box.max);
+	ASSERT_EQUAL((Point{0.0, 0.0, 3.5}), box.centroid());
+	ASSERT_EQUAL_DELTA(2.0 * (2.0 * 4.0 + 4.0 * 1.0 + 1.0 * 2.0), box.surfaceArea(), 1e-12);
+}
+
+void testRayIntersectsBoundingBox() {
+	constexpr BoundingBox box{{-1.0, -1.0, -1.0}, {1.0, 1.0, 1.0}};
+	constexpr Point origin{0.5, 0.0, -5.0};
+	constexpr auto kInfinity = std::numeric_limits<double>::infinity();
+	constexpr Direction inverseDirection{kInfinity, kInfinity, 1.0};
+	double entry{};
+	ASSERT(intersects(box, origin, inverseDirection, 0.0, 100.0, entry));
+	ASSERT_EQUAL_DELTA(4.0, entry, 1e-12);
+	ASSERT(!intersects(box, origin, inverseDirection, 0.0, 3.0, entry));
+	ASSERT(!intersects(box, Point{2.0, 0.0, -5.0}, inverseDirection, 0.0, 100.0, entry));
+}
+
+void testPrecomputedRayIntersectsBoundingBoxLikeRay() {
+	std::mt19937 generator{11};
+	std::uniform_real_distribution<double> coordinate{-3.0, 3.0};
+	constexpr BoundingBox box{{-1.0, -0.5, 0.0}, {1.0, 0.5, 2.0}};
+	for (auto index = 0; index < 1000; ++index) {
+		Ray const ray{{coordinate(generator), coordinate(generator), coordinate(generator)}, {coordinate(generator), coordinate(generator), coordinate(generator)}};
+		PrecomputedRay const precomputed{ray, -1.0, 5.0};
+		double expectedEntry{};
+		double entry{};
+		ASSERT_EQUAL(intersects(box, ray.origin, precomputed.inverseDirection, -1.0, 5.0, expectedEntry), intersects(box, precomputed, entry));
+		ASSERT_EQUAL(expectedEntry, entry);
+	}
+}
+
+void testBoundsOfUnitSphere() {
+	constexpr auto box = bounds(Sphere{});
+	ASSERT_EQUAL((Point{-1.0, -1.0, -1.0}), box.min);
+	ASSERT_EQUAL((Point{1.0, 1.0, 1.0}), box.max);
+}
+
+void testBoundsOfTransformedSphere() {
+	constexpr Sphere sphere{{}, translation(1.0, 2.0, 3.0) * scaling(2.0, 0.5, 1.0)};
+	constexpr auto box = bounds(sphere);
+	ASSERT_EQUAL((Point{-1.0, 1.5, 2.0}), box.min);
+	ASSERT_EQUAL((Point{3.0, 2.5, 4.0}), box.max);
+}
+
+void testTransformedBoundingBoxMatchesTransformedCorners() {
+	constexpr auto matrix = translation(1.0, -2.0, 3.0) * rotation_y(0.6) * shearing(0.3, 0.0, 0.0, 0.7, 0.2, 0.0) * scaling(2.0, 1.0, 0.5);
+	constexpr BoundingBox box{{-1.0, 0.0, 2.0}, {3.0, 1.0, 5.0}};
+	BoundingBox expected{};
+	for (auto corner = 0u; corner < 8; ++corner) {
+		expected.extend(matrix * Point{corner & 1u ? box.max.x : box.min.x, corner & 2u ? box.max.y : box.min.y, corner & 4u ? box.max.z : box.min.z});
+	}
+	constexpr auto result = transformed(matrix, box);
+	ASSERT_EQUAL(expected.min, result.min);
+	ASSERT_EQUAL(expected.max, result.max);
+}
+
+void testTransformedEmptyBoundingBoxStaysEmpty() {
+	ASSERT(transformed(scaling(2.0, 2.0, 2.0), BoundingBox{}).empty());
+}
+
+void testSceneCachesWorldBounds() {
+	Scene scene{};
+	Sphere const sphere{{}, translation(1.0, 2.0, 3.0)};
+	auto const id = scene.add(sphere);
+	ASSERT_EQUAL(bounds(sphere).min, scene.bounds(id).min);
+	ASSERT_EQUAL(bounds(sphere).max, scene.bounds(id).max);
+}
+
+void testBvhCoversEveryShapeOnce() {
+	auto world = randomSphereWorld(500, 1);
+	world.buildBvh();
+	auto const & bvh = world.bvh();
+	ASSERT_EQUAL(500u, bvh.size());
+	std::vector<int> seen(bvh.size());
+	std::size_t depth{};
+	ASSERT_EQUAL(bvh.nodeCount(), checkNode(bvh, 0, seen, depth));
+	ASSERT_EQUAL(std::vector<int>(bvh.size(), 1), seen);
+	ASSERT(bvh.nodeCount() < 2 * bvh.size());
+}
+
+void testParallelBvhBuildMatchesSerialBuild() {
+	std::mt19937 generator{17};
+	std::uniform_real_distribution<double> position{-100.0, 100.0};
+	std::vector<BoundingBox> boxes{};
+	for (auto index = 0; index < 70000; ++index) {
+		Point const corner{position(generator), position(generator), position(generator)};
+		boxes.push_back({corner, corner + Direction{0.5, 0.5, 0.5}});
+	}
+	Bvh const serial{boxes};
+	Bvh const parallel{boxes, 4};
+	ASSERT_EQUAL(serial.shapes(), parallel.shapes());
+	ASSERT_EQUAL(serial.nodeCount(), parallel.nodeCount());
+	for (std::size_t index = 0; index < serial.nodeCount(); ++index) {
+		auto const & lhs = serial.nodes()[index];
+		auto const & rhs = parallel.nodes()[index];
+		ASSERT(lhs.min == rhs.min && lhs.max == rhs.max && lhs.offset == rhs.offset && lhs.count == rhs.count);
+	}
+	ASSERT_EQUAL(serial.statistics().sahCost, parallel.statistics().sahCost);
+}
+
+void testBvhBuildStatistics() {
+	auto world = randomSphereWorld(1000, 18);
+	auto const statistics = world.buildBvh(2);
+	ASSERT_EQUAL(world.bvh().nodeCount(), statistics.nodeCount);
+	ASSERT(statistics.milliseconds >= 0.0);
+	ASSERT(statistics.sahCost > Bvh::kTraversalCost);
+	ASSERT(statistics.sahCost < 0.1 * world.scene().size());
+	ASSERT_EQUAL(0.0, Bvh{std::vector<BoundingBox>{}}.statistics().sahCost);
+}
+
+void testBvhNodesAreHalfACacheLine() {
+	static_assert(sizeof(BvhNode) == 32);
+	static_assert(alignof(BvhNode) == 32);
+	auto world = randomSphereWorld(50, 7);
+	world.buildBvh();
+	auto const address = reinterpret_cast<std::uintptr_t>(world.bvh().nodes().data());
+	ASSERT_EQUAL(0u, address % 32);
+}
+
+void testBvhNodeBoundsRoundOutwards() {
+	std::vector<BoundingBox> const boxes{{{0.1, 0.2, 0.3}, {0.4, 0.5, 0.6}}, {{-0.7, 1.1, 2.3}, {-0.1, 1.3, 2.9}}};
+	Bvh const bvh{boxes};
+	for (auto const & node : bvh.nodes()) {
+		if (!node.leaf()) {
+			continue;
+		}
+		for (auto primitive = node.offset; primitive < node.offset + node.count; ++primitive) {
+			ASSERT(node.bounds<double>().contains(boxes[bvh.shapes()[primitive]]));
+		}
+	}
+	ASSERT(bvh.nodes()[0].bounds<double>().contains(boxes[0]));
+	ASSERT(bvh.nodes()[0].bounds<double>().contains(boxes[1]));
+}
+
+void testBvhDepthStaysWithinTraversalStack() {
+	// Exponentially spaced boxes make every SAH split peel off one shape.
+	std::vector<BoundingBox> boxes{};
+	for (auto index = 0; index < 1000; ++index) {
+		auto const position = std::ldexp(1.0, index / 8);
+		boxes.push_back({{position, 0.0, 0.0}, {position * 1.0001, 1.0, 1.0}});
+	}
+	Bvh const bvh{boxes};
+	std::vector<int> seen(boxes.size());
+	std::size_t depth{};
+	checkNode(bvh, 0, seen, depth);
+	ASSERT_EQUAL(std::vector<int>(boxes.size(), 1), seen);
+	ASSERT(depth <= Bvh::kMaximumDepth);
+}
+
+void testBvhOfEmptyWorld() {
+	Bvh const bvh{std::vector<BoundingBox>{}};
+	ASSERT_EQUAL(0u, bvh.nodeCount());
+	auto visited = false;
+	auto const counters = bvh.traverse(Ray{{}, {0.0, 0.0, 1.0}}, 0.0, 1.0, [&](std::uint32_t, double tMax) {
+		visited = true;
+		return tMax;
+	});
+	ASSERT(!visited);
+	ASSERT_EQUAL(0u, counters.nodesVisited);
+}
+
+void testBvhWorldIntersectionMatchesLinearScan() {
+	auto linear = randomSphereWorld(300, 2);
+	auto accelerated = randomSphereWorld(300, 2);
+	accelerated.buildBvh();
+	ASSERT(!linear.hasBvh());
+	ASSERT(accelerated.hasBvh());
+	for (auto const & ray : randomRays(200, 3)) {
+		ASSERT_EQUAL(linear.intersect(ray), accelerated.intersect(ray));
+	}
+}
+
+void testBvhWorldHitMatchesNearestIntersection() {
+	auto world = randomSphereWorld(300, 4);
+	world.buildBvh();
+	std::size_t hits{};
+	for (auto const & ray : randomRays(200, 5)) {
+		auto const expected = hit(world.intersect(ray));
+		auto const result = world.hit(ray);
+		ASSERT_EQUAL(expected.has_value(), result.has_value());
+		if (expected) {
+			++hits;
+			ASSERT_EQUAL(*expected, *result);
+		}
+	}
+	ASSERT(hits > 0);
+}
+
+void testBvhHitCountsVisitedNodes() {
+	auto world = randomSphereWorld(2000, 8);
+	world.buildBvh();
+	BvhTraversalCounters counters{};
+	auto const rays = randomRays(100, 9);
+	for (auto const & ray : rays) {
+		world.hit(ray, counters);
+	}
+	ASSERT(counters.nodesVisited > 0);
+	ASSERT(counters.nodesVisited < rays.size() * world.bvh().nodeCount() / 10);
+	ASSERT(counters.primitivesVisited < rays.size() * world.scene().size() / 10);
+}
+
+void testBvh4CoversEveryShapeOnce() {
+	auto world = randomSphereWorld(500, 10);
+	world.buildBvh4();
+	ASSERT(world.hasBvh4());
+	auto const & bvh = world.bvh4();
+	static_assert(sizeof(Bvh4Node) == 128);
+	std::vector<int> seen(bvh.size());
+	checkNode4(bvh, 0, seen);
+	ASSERT_EQUAL(std::vector<int>(bvh.size(), 1), seen);
+	ASSERT(bvh.nodeCount() < world.bvh().nodeCount() / 2);
+}
+
+void testBvh4OfSingleShape() {
+	Bvh4 const bvh{std::vector<BoundingBox>{bounds(Sphere{})}};
+	ASSERT_EQUAL(1u, bvh.nodeCount());
+	std::vector<std::uint32_t> visited{};
+	bvh.traverse(Ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}}, 0.0, 100.0, [&](std::uint32_t const primitive, double tMax) {
+		visited.push_back(primitive);
+		return tMax;
+	});
+	ASSERT_EQUAL(std::vector<std::uint32_t>{0}, visited);
+}
+
+void testBvh4WorldMatchesLinearScan() {
+	auto linear = randomSphereWorld(300, 11);
+	auto accelerated = randomSphereWorld(300, 11);
+	accelerated.buildBvh4();
+	for (auto const & ray : randomRays(200, 12)) {
+		ASSERT_EQUAL(linear.intersect(ray), accelerated.intersect(ray));
+		ASSERT_EQUAL(linear.hit(ray).has_value(), accelerated.hit(ray).has_value());
+		if (auto const expected = linear.hit(ray)) {
+			ASSERT_EQUAL(*expected, *accelerated.hit(ray));
+		}
+	}
+}
+
+void testBvh4FloatWorldMatchesLinearScan() {
+	WorldF linear{};
+	WorldF accelerated{};
+	std::mt19937 generator{13};
+	std::uniform_real_distribution<float> position{-20.0f, 20.0f};
+	for (auto index = 0; index < 300; ++index) {
+		Shapes::SphereF const sphere{{}, translation(position(generator), position(generator), position(generator))};
+		linear.add(sphere);
+		accelerated.add(sphere);
+	}
+	accelerated.buildBvh4();
+	for (auto const & ray : randomRays(200, 14)) {
+		RayF const rayF{{float(ray.origin.x), float(ray.origin.y), float(ray.origin.z)}, {float(ray.direction.x), float(ray.direction.y), float(ray.direction.z)}};
+		ASSERT_EQUAL(linear.intersect(rayF), accelerated.intersect(rayF));
+	}
+}
+
+void testBvh4HalvesTraversalSteps() {
+	auto world = randomSphereWorld(5000, 15);
+	auto const rays = randomRays(300, 16);
+	world.buildBvh();
+	BvhTraversalCounters binary{};
+	for (auto const & ray : rays) {
+		world.hit(ray, binary);
+	}
+	world.buildBvh4();
+	BvhTraversalCounters wide{};
+	for (auto const & ray : rays) {
+		world.hit(ray, wide);
+	}
+	ASSERT(2 * wide.nodesVisited <= binary.nodesVisited);
+}
+
+void testRefitFollowsMovedShapes() {
+	auto linear = randomSphereWorld(400, 19);
+	auto accelerated = randomSphereWorld(400, 19);
+	accelerated.buildBvh();
+	for (std::uint32_t shape = 0; shape < 400; shape += 20) {
+		Direction const offset{0.5, -0.25, 0.75};
+		move(linear, ShapeId{shape}, offset);
+		move(accelerated, ShapeId{shape}, offset);
+	}
+	ASSERT(!accelerated.hasBvh());
+	auto const statistics = accelerated.refitBvh();
+	ASSERT(accelerated.hasBvh());
+	ASSERT(statistics.nodesRefitted > 0);
+	ASSERT(statistics.nodesRefitted < accelerated.bvh().nodeCount() / 2);
+	ASSERT_EQUAL(0u, statistics.primitivesRebuilt);
+	checkCoversEveryShapeOnce(accelerated.bvh());
+	for (auto const & ray : randomRays(200, 20)) {
+		ASSERT_EQUAL(linear.intersect(ray), accelerated.intersect(ray));
+	}
+}
+
+void testRefitRebuildsDegradedSubtrees() {
+	auto linear = randomSphereWorld(400, 21);
+	auto accelerated = randomSphereWorld(400, 21);
+	auto const builtCost = accelerated.buildBvh().sahCost;
+	// The primitives below the root's left grandchild are contiguous.
+	// Rotating their positions among themselves keeps the bounds of that
+	// subtree but stretches its leaves, which rebuilding it repairs.
+	auto const & bvh = accelerated.bvh();
+	auto const end = primitiveEnd(bvh, bvh.nodes()[1].leaf() ? 1u : 2u);
+	std::vector<ShapeId> shapes{};
+	std::vector<Point> centers{};
+	for (std::uint32_t primitive = 0; primitive < end; ++primitive) {
+		shapes.push_back(ShapeId{bvh.shapes()[primitive]});
+		centers.push_back(bounds(linear.scene()[shapes.back()]).centroid());
+	}
+	for (std::size_t index = 0; index < shapes.size(); ++index) {
+		auto const offset = centers[(index + shapes.size() / 2) % shapes.size()] - centers[index];
+		move(linear, shapes[index], offset);
+		move(accelerated, shapes[index], offset);
+	}
+	auto const statistics = accelerated.refitBvh(1.1);
+	ASSERT(statistics.primitivesRebuilt > 0);
+	ASSERT(statistics.primitivesRebuilt < accelerated.scene().size());
+	ASSERT(statistics.sahCost <= 1.1 * builtCost);
+	ASSERT_EQUAL(builtCost, accelerated.bvh().referenceSahCost());
+	checkCoversEveryShapeOnce(accelerated.bvh());
+	for (auto const & ray : randomRays(200, 22)) {
+		ASSERT_EQUAL(linear.intersect(ray), accelerated.intersect(ray));
+		ASSERT_EQUAL(linear.hit(ray).has_value(), accelerated.hit(ray).has_value());
+	}
+}
+
+void testRepeatedRefitsStayCloseToFreshBuild() {
+	auto linear = randomSphereWorld(1000, 25);
+	auto accelerated = randomSphereWorld(1000, 25);
+	accelerated.buildBvh();
+	std::mt19937 generator{26};
+	std::uniform_int_distribution<std::uint32_t> shape{0, 999};
+	std::uniform_real_distribution<double> position{-20.0, 20.0};
+	std::size_t fullRebuilds{};
+	for (auto round = 0; round < 20; ++round) {
+		for (auto moved = 0; moved < 20; ++moved) {
+			ShapeId const id{shape(generator)};
+			auto const center = bounds(linear.scene()[id]).centroid();
+			Direction const offset{position(generator) - center.x, position(generator) - center.y, position(generator) - center.z};
+			move(linear, id, offset);
+			move(accelerated, id, offset);
+		}
+		auto const statistics = accelerated.refitBvh();
+		ASSERT(statistics.sahCost <= 1.5 * accelerated.bvh().referenceSahCost());
+		fullRebuilds += statistics.primitivesRebuilt == accelerated.scene().size();
+	}
+	ASSERT(fullRebuilds > 0);
+	ASSERT(accelerated.bvh().sahCost() <= 1.5 * Bvh{accelerated.scene().bounds()}.sahCost());
+	checkCoversEveryShapeOnce(accelerated.bvh());
+	for (auto const & ray : randomRays(200, 27)) {
+		ASSERT_EQUAL(linear.intersect(ray), accelerated.intersect(ray));
+	}
+}
+
+void testRebuildKeepsBuildThreads() {
+	auto linear = randomSphereWorld(1000, 25);
+	auto accelerated = randomSphereWorld(1000, 25);
+	accelerated.buildBvh(4);
+	ASSERT_EQUAL(4u, accelerated.bvh().threads());
+	std::mt19937 generator{26};
+	std::uniform_int_distribution<std::uint32_t> shape{0, 999};
+	std::uniform_real_distribution<double> position{-20.0, 20.0};
+	std::size_t rebuilt{};
+	for (auto round = 0; round < 20; ++round) {
+		for (auto moved = 0; moved < 20; ++moved) {
+			ShapeId const id{shape(generator)};
+			auto const center = bounds(linear.scene()[id]).centroid();
+			Direction const offset{position(generator) - center.x, position(generator) - center.y, position(generator) - center.z};
+			move(linear, id, offset);
+			move(accelerated, id, offset);
+		}
+		rebuilt += accelerated.refitBvh().primitivesRebuilt;
+		ASSERT_EQUAL(4u, accelerated.bvh().threads());
+	}
+	ASSERT(rebuilt > 0);
+	checkCoversEveryShapeOnce(accelerated.bvh());
+	for (auto const & ray : randomRays(200, 27)) {
+		ASSERT_EQUAL(linear.intersect(ray), accelerated.intersect(ray));
+	}
+}
+
+void testRefitOfWideBvh() {
+	auto linear = randomSphereWorld(400, 23);
+	auto accelerated = randomSphereWorld(400, 23);
+	accelerated.buildBvh4();
+	for (std::uint32_t shape = 0; shape < 400; shape += 10) {
+		Direction const offset{0.0, 1.0, -0.5};
+		move(linear, ShapeId{shape}, offset);
+		move(accelerated, ShapeId{shape}, offset);
+	}
+	accelerated.refitBvh();
+	ASSERT(accelerated.hasBvh4());
+	for (auto const & ray : randomRays(200, 24)) {
+		ASSERT_EQUAL(linear.intersect(ray), accelerated.intersect(ray));
+	}
+}
+
+void testAddingShapeDiscardsBvh() {
+	auto world = randomSphereWorld(10, 6);
+	world.buildBvh();
+	auto const added = world.add(Sphere{{}, translation(0.0, 0.0, 50.0)});
+	ASSERT(!world.hasBvh());
+	auto const result = world.hit(Ray{{0.0, 0.0, 45.0}, {0.0, 0.0, 1.0}});
+	ASSERT_EQUAL(added, result.value().shape);
+	world.buildBvh4();
+	world.add(Sphere{});
+	ASSERT(!world.hasBvh4());
+}
+
+cute::suite make_suite_BvhTestSuite() {
+	cute::suite s { };
+	s.push_back(CUTE(testDefaultBoundingBoxIsEmpty));
+	s.push_back(CUTE(testBoundingBoxExtendsToPoints));
+	s.push_back(CUTE(testRayIntersectsBoundingBox));
+	s.push_back(CUTE(testPrecomputedRayIntersectsBoundingBoxLikeRay));
+	s.push_back(CUTE(testBoundsOfUnitSphere));
+	s.push_back(CUTE(testBoundsOfTransformedSphere));
+	s.push_back(CUTE(testTransformedBoundingBoxMatchesTransformedCorners));
+	s.push_back(CUTE(testTransformedEmptyBoundingBoxStaysEmpty));
+	s.push_back(CUTE(testSceneCachesWorldBounds));
+	s.push_back(CUTE(testBvhCoversEveryShapeOnce));
+	s.push_back(CUTE(testParallelBvhBuildMatchesSerialBuild));
+	s.push_back(CUTE(testBvhBuildStatistics));
+	s.push_back(CUTE(testBvhNodesAreHalfACacheLine));
+	s.push_back(CUTE(testBvhNodeBoundsRoundOutwards));
+	s.push_back(CUTE(testBvhDepthStaysWithinTraversalStack));
+	s.push_back(CUTE(testBvhOfEmptyWorld));
+	s.push_back(CUTE(testBvhWorldIntersectionMatchesLinearScan));
+	s.push_back(CUTE(testBvhWorldHitMatchesNearestIntersection));
+	s.push_back(CUTE(testBvhHitCountsVisitedNodes));
+	s.push_back(CUTE(testBvh4CoversEveryShapeOnce));
+	s.push_back(CUTE(testBvh4OfSingleShape));
+	s.push_back(CUTE(testBvh4WorldMatchesLinearScan));
+	s.push_back(CUTE(testBvh4FloatWorldMatchesLinearScan));
+	s.push_back(CUTE(testBvh4HalvesTraversalSteps));
+	s.push_back(CUTE(testRefitFollowsMovedShapes));
+	s.push_back(CUTE(testRefitRebuildsDegradedSubtrees));
+	s.push_back(CUTE(testRepeatedRefitsStayCloseToFreshBuild));
+	s.push_back(CUTE(testRebuildKeepsBuildThreads));
+	s.push_back(CUTE(testRefitOfWideBvh));
+	s.push_back(CUTE(testAddingShapeDiscardsBvh));
+	return s;
+}
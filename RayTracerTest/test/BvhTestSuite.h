@@ -0,0 +1,8 @@
+#ifndef BVHTESTSUITE_H_
+#define BVHTESTSUITE_H_
+
+#include "cute_suite.h"
+
+extern cute::suite make_suite_BvhTestSuite();
+
+#endif /* BVHTESTSUITE_H_ */
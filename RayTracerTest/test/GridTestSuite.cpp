@@ -0,0 +1,189 @@
+#include "GridTestSuite.h"
+#include "BoundingBox.h"
+#include "Bvh.h"
+#include "Grid.h"
+#include "Intersections.h"
+#include "Point.h"
+#include "RandomScenes.h"
+#include "Ray.h"
+#include "Sphere.h"
+#include "TransformChain.h"
+#include "Transformations.h"
+#include "World.h"
+#include "cute.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+
+using Shapes::Sphere;
+
+namespace {
+
+// Counts allocations so tests can check that a query does not allocate.
+std::atomic<std::size_t> allocations{};
+
+}
+
+void * operator new(std::size_t const size) {
+	++allocations;
+	if (auto * const memory = std::malloc(size == 0 ? 1 : size)) {
+		return memory;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete(void * const memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void * const memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+void testGridResolutionFollowsShapeCount() {
+	auto world = randomSphereWorld(1000, 1, 20.0, 0.3, 0.6);
+	world.buildGrid();
+	auto const & grid = world.grid();
+	for (auto const cells : grid.resolution()) {
+		ASSERT(cells >= 10 && cells <= 14);
+	}
+	ASSERT(grid.cellCount() >= 1000 && grid.cellCount() <= 4000);
+}
+
+void testFlatGridIsOneCellThick() {
+	std::vector<BoundingBox> boxes{};
+	for (auto index = 0; index < 100; ++index) {
+		boxes.push_back({{double(index % 10), double(index / 10), 0.0}, {index % 10 + 0.5, index / 10 + 0.5, 0.0}});
+	}
+	Grid const grid{boxes};
+	ASSERT_EQUAL(1u, grid.resolution()[2]);
+	ASSERT(grid.resolution()[0] > 1);
+}
+
+void testGridListsShapeInEveryOverlappedCell() {
+	std::vector<BoundingBox> const boxes{{{0.0, 0.0, 0.0}, {4.0, 4.0, 4.0}}, {{0.5, 0.5, 0.5}, {1.5, 3.5, 0.9}}};
+	Grid const grid{boxes};
+	auto const & resolution = grid.resolution();
+	for (std::size_t z = 0; z < resolution[2]; ++z) {
+		for (std::size_t y = 0; y < resolution[1]; ++y) {
+			for (std::size_t x = 0; x < resolution[0]; ++x) {
+				auto const shapes = grid.cell(x, y, z);
+				ASSERT(shapes.size() >= 1);
+				ASSERT_EQUAL(0u, shapes[0]);
+			}
+		}
+	}
+}
+
+void testGridOfEmptyWorld() {
+	World world{};
+	world.buildGrid();
+	ASSERT(!world.hasGrid());
+	ASSERT(!world.hit(Ray{{}, {0.0, 0.0, 1.0}}));
+	ASSERT(!world.anyHit(Ray{{}, {0.0, 0.0, 1.0}}));
+}
+
+void testGridWorldMatchesLinearScan() {
+	auto linear = randomSphereWorld(500, 2, 20.0, 0.3, 0.6);
+	auto accelerated = randomSphereWorld(500, 2, 20.0, 0.3, 0.6);
+	accelerated.buildGrid();
+	ASSERT(accelerated.hasGrid());
+	ASSERT(!accelerated.hasBvh());
+	std::size_t hits{};
+	for (auto const & ray : randomRays(300, 3)) {
+		ASSERT_EQUAL(linear.intersect(ray), accelerated.intersect(ray));
+		auto const expected = linear.hit(ray);
+		auto const result = accelerated.hit(ray);
+		ASSERT_EQUAL(expected.has_value(), result.has_value());
+		if (expected) {
+			++hits;
+			ASSERT_EQUAL(*expected, *result);
+		}
+	}
+	ASSERT(hits > 0);
+	// A tangent ray meets the sphere twice at the same time.
+	World tangent{};
+	tangent.add(Sphere{{}, Transforms::translation(0.0, 1.0, 5.0)});
+	tangent.add(Sphere{{}, Transforms::translation(4.0, -3.0, 2.0)});
+	constexpr Ray ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}};
+	auto const expected = tangent.intersect(ray);
+	ASSERT_EQUAL(2u, expected.size());
+	tangent.buildGrid();
+	ASSERT_EQUAL(expected, tangent.intersect(ray));
+}
+
+void testGridIntersectReusesBuffer() {
+	auto world = randomSphereWorld(500, 2, 20.0, 0.3, 0.6);
+	world.buildGrid();
+	auto const rays = randomRays(50, 3);
+	std::vector<IntersectionBuffer> expected{};
+	for (auto const & ray : rays) {
+		expected.push_back(world.intersect(ray));
+	}
+	IntersectionBuffer buffer{};
+	buffer.reserve(2 * world.scene().size());
+	world.intersect(rays.front(), buffer);
+	for (std::size_t index = 0; index < rays.size(); ++index) {
+		auto const before = allocations.load();
+		world.intersect(rays[index], buffer);
+		auto const allocated = allocations.load() - before;
+		ASSERT_EQUAL(0u, allocated);
+		ASSERT_EQUAL(expected[index], buffer);
+	}
+}
+
+void testAnyHitAgreesWithNearestHit() {
+	auto linear = randomSphereWorld(500, 4, 20.0, 0.3, 0.6);
+	auto grid = randomSphereWorld(500, 4, 20.0, 0.3, 0.6);
+	grid.buildGrid();
+	auto bvh = randomSphereWorld(500, 4, 20.0, 0.3, 0.6);
+	bvh.buildBvh4();
+	for (auto const & ray : randomRays(300, 5)) {
+		auto const nearest = linear.hit(ray);
+		for (auto const maxTime : {10.0, 40.0, 1000.0}) {
+			auto const expected = nearest.has_value() && nearest->time < maxTime;
+			ASSERT_EQUAL(expected, linear.anyHit(ray, maxTime));
+			ASSERT_EQUAL(expected, grid.anyHit(ray, maxTime));
+			ASSERT_EQUAL(expected, bvh.anyHit(ray, maxTime));
+		}
+	}
+}
+
+void testGridVisitsFewCells() {
+	auto world = randomSphereWorld(5000, 6, 20.0, 0.3, 0.6);
+	world.buildGrid();
+	BvhTraversalCounters counters{};
+	auto const rays = randomRays(100, 7);
+	for (auto const & ray : rays) {
+		world.hit(ray, counters);
+	}
+	ASSERT(counters.nodesVisited > 0);
+	ASSERT(counters.nodesVisited < rays.size() * world.grid().cellCount() / 20);
+}
+
+void testMovingShapeDiscardsGrid() {
+	auto world = randomSphereWorld(20, 8, 20.0, 0.3, 0.6);
+	world.buildGrid();
+	world.setTransform(ShapeId{0}, translation(0.0, 0.0, 100.0));
+	ASSERT(!world.hasGrid());
+	ASSERT_EQUAL(ShapeId{0}, world.hit(Ray{{0.0, 0.0, 90.0}, {0.0, 0.0, 1.0}}).value().shape);
+}
+
+cute::suite make_suite_GridTestSuite() {
+	cute::suite s { };
+	s.push_back(CUTE(testGridResolutionFollowsShapeCount));
+	s.push_back(CUTE(testFlatGridIsOneCellThick));
+	s.push_back(CUTE(testGridListsShapeInEveryOverlappedCell));
+	s.push_back(CUTE(testGridOfEmptyWorld));
+	s.push_back(CUTE(testGridWorldMatchesLinearScan));
+	s.push_back(CUTE(testGridIntersectReusesBuffer));
+	s.push_back(CUTE(testAnyHitAgreesWithNearestHit));
+	s.push_back(CUTE(testGridVisitsFewCells));
+	s.push_back(CUTE(testMovingShapeDiscardsGrid));
+	return s;
+}
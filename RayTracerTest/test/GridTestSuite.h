@@ -0,0 +1,8 @@
+#ifndef GRIDTESTSUITE_H_
+#define GRIDTESTSUITE_H_
+
+#include "cute_suite.h"
+
+extern cute::suite make_suite_GridTestSuite();
+
+#endif /* GRIDTESTSUITE_H_ */
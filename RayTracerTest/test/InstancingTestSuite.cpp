@@ -0,0 +1,216 @@
+#include "InstancingTestSuite.h"
+#include "Bvh.h"
+#include "Color.h"
+#include "Instancing.h"
+#include "Intersections.h"
+#include "Material.h"
+#include "Pi.h"
+#include "Point.h"
+#include "RandomScenes.h"
+#include "Ray.h"
+#include "Sphere.h"
+#include "Transform.h"
+#include "Transformations.h"
+#include "World.h"
+#include "cute.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+
+using Shapes::Sphere;
+
+namespace {
+
+Material colored(Color const & color) {
+	auto material = defaultMaterial;
+	material.color = color;
+	return material;
+}
+
+// Three spheres in a row, the middle one stretched.
+std::vector<Sphere> cluster() {
+	return {
+		Sphere{{}, translation(-2.0, 0.0, 0.0) * scaling(0.5, 0.5, 0.5), colored({1.0, 0.0, 0.0})},
+		Sphere{{}, scaling(1.0, 0.5, 0.5), colored({0.0, 1.0, 0.0})},
+		Sphere{{}, translation(2.0, 0.0, 0.0) * scaling(0.5, 0.5, 0.5), colored({0.0, 0.0, 1.0})}
+	};
+}
+
+std::vector<Transform> randomPlacements(std::size_t const count, unsigned const seed) {
+	std::mt19937 generator{seed};
+	std::uniform_real_distribution<double> position{-30.0, 30.0};
+	std::uniform_real_distribution<double> angle{0.0, 3.0};
+	std::uniform_real_distribution<double> scale{0.3, 1.2};
+	std::vector<Transform> placements{};
+	for (std::size_t index = 0; index < count; ++index) {
+		placements.push_back(Transform{translation(position(generator), position(generator), position(generator)) *
+				rotation_y(angle(generator)) * rotation_z(angle(generator)) *
+				scaling(scale(generator), scale(generator), scale(generator))});
+	}
+	return placements;
+}
+
+InstancedScene instancedScene(std::vector<Transform> const & placements) {
+	InstancedScene scene{};
+	auto const geometry = scene.add(Geometry{cluster()});
+	for (auto const & placement : placements) {
+		scene.add(Instance{geometry, placement, {}});
+	}
+	return scene;
+}
+
+// The same spheres as instancedScene, each with its own composed transform.
+// Shape instance * 3 + shape stands for shape of instance.
+World flattenedWorld(std::vector<Transform> const & placements) {
+	World world{};
+	for (auto const & placement : placements) {
+		for (auto const & sphere : cluster()) {
+			world.add(Sphere{sphere.position, Transform{placement.matrix() * sphere.transform.matrix()}, sphere.material});
+		}
+	}
+	return world;
+}
+
+}
+
+void testGeometryMapsShapeIdsToItsSpheres() {
+	Geometry const geometry{cluster()};
+	ASSERT_EQUAL(3u, geometry.size());
+	ASSERT_EQUAL(cluster()[2].transform, geometry[ShapeId{2}].transform);
+	ASSERT_EQUAL(Point(-2.5, -0.5, -0.5), geometry.bounds().min);
+	ASSERT_EQUAL(Point(2.5, 0.5, 0.5), geometry.bounds().max);
+}
+
+void testEmptyGeometryIsRejected() {
+	ASSERT_THROWS(Geometry{std::vector<Sphere>{}}, std::invalid_argument);
+}
+
+void testInstanceOfUnknownGeometryIsRejected() {
+	InstancedScene scene{};
+	ASSERT_THROWS(scene.add(Instance{GeometryId{0}, {}, {}}), std::invalid_argument);
+}
+
+void testInstanceBoundsAreTransformedGeometryBounds() {
+	InstancedScene scene{};
+	auto const geometry = scene.add(Geometry{cluster()});
+	auto const instance = scene.add(Instance{geometry, Transform{translation(0.0, 5.0, 0.0) * rotation_z(pi<double> / 2)}, {}});
+	auto const & bounds = scene.bounds(instance);
+	ASSERT_EQUAL_DELTA(-0.5, bounds.min.x, 1e-12);
+	ASSERT_EQUAL_DELTA(2.5, bounds.min.y, 1e-12);
+	ASSERT_EQUAL_DELTA(0.5, bounds.max.x, 1e-12);
+	ASSERT_EQUAL_DELTA(7.5, bounds.max.y, 1e-12);
+}
+
+void testInstancesShareGeometry() {
+	auto const scene = instancedScene(randomPlacements(1000, 1));
+	ASSERT_EQUAL(1u, scene.geometries().size());
+	ASSERT_EQUAL(1000u, scene.instances().size());
+	ASSERT_EQUAL(3u, scene.geometries().front().size());
+}
+
+void testInstancedHitMatchesFlattenedWorld() {
+	auto const placements = randomPlacements(300, 2);
+	auto scene = instancedScene(placements);
+	auto world = flattenedWorld(placements);
+	world.buildBvh();
+	for (auto const withBvh : {false, true}) {
+		if (withBvh) {
+			scene.buildBvh();
+		}
+		ASSERT_EQUAL(withBvh, scene.hasBvh());
+		for (auto const & ray : randomRays(500, 3, 30.0, -50.0)) {
+			auto const instanced = scene.hit(ray);
+			auto const flattened = world.hit(ray);
+			ASSERT_EQUAL(flattened.has_value(), instanced.has_value());
+			if (flattened) {
+				ASSERT_EQUAL_DELTA(flattened->time, instanced->time, 1e-9);
+				ASSERT_EQUAL(flattened->shape.value, instanced->instance.value * 3 + instanced->shape.value);
+			}
+		}
+	}
+}
+
+void testInstancedAnyHitMatchesFlattenedWorld() {
+	auto const placements = randomPlacements(300, 4);
+	auto scene = instancedScene(placements);
+	scene.buildBvh();
+	auto const world = flattenedWorld(placements);
+	for (auto const & ray : randomRays(500, 5, 30.0, -50.0)) {
+		ASSERT_EQUAL(world.anyHit(ray, 60.0), scene.anyHit(ray, 60.0));
+	}
+}
+
+void testTopLevelPrunesInstances() {
+	auto scene = instancedScene(randomPlacements(2000, 6));
+	scene.buildBvh();
+	BvhTraversalCounters counters{};
+	auto const rays = randomRays(200, 7, 30.0, -50.0);
+	for (auto const & ray : rays) {
+		scene.hit(ray, counters);
+	}
+	ASSERT(counters.primitivesVisited < 50 * rays.size());
+}
+
+void testAddingInstanceDiscardsTopLevel() {
+	auto scene = instancedScene(randomPlacements(10, 8));
+	scene.buildBvh();
+	scene.add(Instance{GeometryId{0}, Transform{translation(0.0, 0.0, 100.0)}, {}});
+	ASSERT(!scene.hasBvh());
+	auto const hit = scene.hit(Ray{{0.0, 0.0, 90.0}, {0.0, 0.0, 1.0}});
+	ASSERT_EQUAL(InstanceId{10}, hit.value().instance);
+	ASSERT_EQUAL(ShapeId{1}, hit.value().shape);
+}
+
+void testMaterialOverride() {
+	InstancedScene scene{};
+	auto const geometry = scene.add(Geometry{cluster()});
+	auto const plain = scene.add(Instance{geometry, Transform{translation(0.0, 0.0, 0.0)}, {}});
+	auto const red = colored({1.0, 0.0, 0.0});
+	auto const overridden = scene.add(Instance{geometry, Transform{translation(0.0, 10.0, 0.0)}, red});
+	scene.buildBvh();
+	auto const first = scene.hit(Ray{{2.0, 0.0, -5.0}, {0.0, 0.0, 1.0}});
+	ASSERT_EQUAL(plain, first.value().instance);
+	ASSERT_EQUAL(colored({0.0, 0.0, 1.0}), scene.material(*first));
+	auto const second = scene.hit(Ray{{2.0, 10.0, -5.0}, {0.0, 0.0, 1.0}});
+	ASSERT_EQUAL(overridden, second.value().instance);
+	ASSERT_EQUAL(red, scene.material(*second));
+}
+
+void testInstancedNormalMatchesFlattenedWorld() {
+	auto const placements = randomPlacements(50, 9);
+	auto scene = instancedScene(placements);
+	scene.buildBvh();
+	auto const world = flattenedWorld(placements);
+	for (auto const & ray : randomRays(200, 10, 30.0, -50.0)) {
+		auto const hit = scene.hit(ray);
+		if (!hit) {
+			continue;
+		}
+		auto const point = ray.position(hit->time);
+		auto const expected = normalAt(world.scene()[ShapeId{hit->instance.value * 3 + hit->shape.value}], point);
+		auto const actual = scene.normalAt(*hit, point);
+		ASSERT_EQUAL_DELTA(expected.x, actual.x, 1e-9);
+		ASSERT_EQUAL_DELTA(expected.y, actual.y, 1e-9);
+		ASSERT_EQUAL_DELTA(expected.z, actual.z, 1e-9);
+	}
+}
+
+cute::suite make_suite_InstancingTestSuite() {
+	cute::suite s { };
+	s.push_back(CUTE(testGeometryMapsShapeIdsToItsSpheres));
+	s.push_back(CUTE(testEmptyGeometryIsRejected));
+	s.push_back(CUTE(testInstanceOfUnknownGeometryIsRejected));
+	s.push_back(CUTE(testInstanceBoundsAreTransformedGeometryBounds));
+	s.push_back(CUTE(testInstancesShareGeometry));
+	s.push_back(CUTE(testInstancedHitMatchesFlattenedWorld));
+	s.push_back(CUTE(testInstancedAnyHitMatchesFlattenedWorld));
+	s.push_back(CUTE(testTopLevelPrunesInstances));
+	s.push_back(CUTE(testAddingInstanceDiscardsTopLevel));
+	s.push_back(CUTE(testMaterialOverride));
+	s.push_back(CUTE(testInstancedNormalMatchesFlattenedWorld));
+	return s;
+}
@@ -0,0 +1,8 @@
+#ifndef INSTANCINGTESTSUITE_H_
+#define INSTANCINGTESTSUITE_H_
+
+#include "cute_suite.h"
+
+extern cute::suite make_suite_InstancingTestSuite();
+
+#endif /* INSTANCINGTESTSUITE_H_ */
@@ -57,6 +57,14 @@ void testLightingWithLightBehindSurface() {
 	ASSERT_EQUAL(expected, result);
 }
 
+void testLightingWithSurfaceInShadow() {
+	constexpr Color expected{0.1, 0.1, 0.1};
+	constexpr Direction eye{0.0, 0.0, -1.0};
+	constexpr auto light = pointLight({0.0, 0.0, -10.0}, Colors::white);
+	constexpr auto result = lighting(defaultMaterial, light, position, eye, normal, true);
+	ASSERT_EQUAL(expected, result);
+}
+
 cute::suite make_suite_LightTestSuite() {
 	cute::suite s { };
 	s.push_back(CUTE(testLightHasPointAndIntensity));
@@ -65,5 +73,6 @@ cute::suite make_suite_LightTestSuite() {
 	s.push_back(CUTE(testLightingWithEyeOppositeSurfaceLightAt45DegreeAngle));
 	s.push_back(CUTE(testLightingWithEyeInPathOfReflectionVector));
 	s.push_back(CUTE(testLightingWithLightBehindSurface));
+	s.push_back(CUTE(testLightingWithSurfaceInShadow));
 	return s;
 }
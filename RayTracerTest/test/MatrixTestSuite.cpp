@@ -1,10 +1,12 @@
 #include "MatrixTestSuite.h"
 #include "Matrix.h"
+#include "MatrixKernels.h"
 #include "Direction.h"
 #include "Point.h"
 #include "cute.h"
 
 #include <array>
+#include <vector>
 
 
 
@@ -470,6 +472,234 @@ void testEffectOfModifiedIdentity() {
 	ASSERT_EQUAL(expected, tuple * modifiedIdentiy);
 }
 
+void testClosedFormDeterminantMatchesCofactorExpansion() {
+	constexpr Matrix<4, 4> matrix {
+		-2.0, -8.0,  3.0,  5.0,
+		-3.0,  1.0,  7.0,  3.0,
+		 1.0,  2.0, -9.0,  6.0,
+		-6.0,  7.0,  7.0, -9.0
+	};
+	ASSERT_EQUAL(cofactorDeterminant(matrix), determinant(matrix));
+}
+
+void testClosedFormThreeByThreeDeterminantMatchesCofactorExpansion() {
+	constexpr Matrix<3, 3> matrix {
+		 1.0,  2.0,  6.0,
+		-5.0,  8.0, -4.0,
+		 2.0,  6.0,  4.0
+	};
+	ASSERT_EQUAL(cofactorDeterminant(matrix), determinant(matrix));
+}
+
+void testClosedFormInverseMatchesCofactorInverse() {
+	constexpr std::array<Matrix<4, 4>, 3> matrices {{
+		{
+			-5.0,  2.0,  6.0, -8.0,
+			 1.0, -5.0,  1.0,  8.0,
+			 7.0,  7.0, -6.0, -7.0,
+			 1.0, -3.0,  7.0,  4.0
+		}, {
+			 8.0, -5.0,  9.0,  2.0,
+			 7.0,  5.0,  6.0,  1.0,
+			-6.0,  0.0,  9.0,  6.0,
+			-3.0,  0.0, -9.0, -4.0
+		}, {
+			 9.0,  3.0,  0.0,  9.0,
+			-5.0, -2.0, -6.0, -3.0,
+			-4.0,  9.0,  6.0,  4.0,
+			-7.0,  6.0,  6.0,  2.0
+		}
+	}};
+	for (auto const & matrix : matrices) {
+		ASSERT_EQUAL(cofactorInverse(matrix), inverse(matrix));
+	}
+}
+
+void testInverseOfThreeByThree() {
+	constexpr Matrix<3, 3> matrix {
+		 1.0,  2.0,  6.0,
+		-5.0,  8.0, -4.0,
+		 2.0,  6.0,  4.0
+	};
+	constexpr auto result = inverse(matrix);
+	ASSERT_EQUAL(cofactorInverse(matrix), result);
+	ASSERT_EQUAL(identity<3>, matrix * result);
+}
+
+void testInverseOfThreeByThreeWithDeterminantZeroThrows() {
+	constexpr Matrix<3, 3> matrix {
+		1.0, 2.0, 3.0,
+		2.0, 4.0, 6.0,
+		0.0, 1.0, 1.0
+	};
+	ASSERT_THROWS(inverse(matrix), std::invalid_argument);
+}
+
+void testMultiplyKernelsMatchGenericProduct() {
+	constexpr Matrix<4, 4> lhs {
+		 3.0, -9.0,  7.0,  3.0,
+		 3.0, -8.0,  2.0, -9.0,
+		-4.0,  4.0,  4.0,  1.0,
+		-6.0,  5.0, -1.0,  1.0
+	};
+	constexpr Matrix<4, 4> rhs {
+		 8.0,  2.0,  2.0,  2.0,
+		 3.0, -1.0,  7.0,  0.0,
+		 7.0,  0.0,  5.0,  4.0,
+		 6.0, -2.0,  0.0,  5.0
+	};
+	constexpr auto expected = operator*<4, 4, 4, double>(lhs, rhs);
+	std::vector<kernels::KernelTable> tables{kernels::scalar};
+#ifdef RAYTRACER_X86_KERNELS
+	tables.push_back(kernels::sse2);
+	if (kernels::supported(kernels::avx2)) {
+		tables.push_back(kernels::avx2);
+	}
+#endif
+	for (auto const & table : tables) {
+		Matrix<4, 4> result{};
+		table.multiply(lhs.values.data(), rhs.values.data(), result.values.data());
+		ASSERT_EQUALM(table.name, expected, result);
+	}
+}
+
+void testRuntimeProductMatchesCompileTimeProduct() {
+	constexpr Matrix<4, 4> lhs {
+		 1.0,  2.0,  3.0,  4.0,
+		 2.0,  3.0,  4.0,  5.0,
+		 3.0,  4.0,  5.0,  6.0,
+		 4.0,  5.0,  6.0,  7.0
+	};
+	constexpr Matrix<4, 4> rhs {
+		 0.0,  1.0,  2.0,  4.0,
+		 1.0,  2.0,  4.0,  8.0,
+		 2.0,  4.0,  8.0, 16.0,
+		 4.0,  8.0, 16.0, 32.0
+	};
+	constexpr auto compileTime = lhs * rhs;
+	auto const runtime = lhs * rhs;
+	ASSERT_EQUAL(compileTime, runtime);
+}
+
+void testCompileTimeIndexedAccess() {
+	constexpr Matrix<3, 3> matrix {
+		-3.0,  5.0,  0.0,
+		 1.0, -2.0, -7.0,
+		 0.0,  1.0,  1.0
+	};
+	constexpr std::array<double, 3> expectedValues{5.0, -7.0, 1.0};
+	constexpr std::array<double, 3> actualValues{matrix.get<0, 1>(), matrix.get<1, 2>(), matrix.get<2, 2>()};
+	ASSERT_EQUAL(expectedValues, actualValues);
+}
+
+void testCheckedAccessThrowsOutsideOfMatrix() {
+	Matrix<2, 3, double, CheckedAccess> const matrix{};
+	ASSERT_THROWS((matrix[2_row, 0_column]), std::invalid_argument);
+	ASSERT_THROWS((matrix[0_row, 3_column]), std::invalid_argument);
+}
+
+void testUncheckedAccessComputesSameInverse() {
+	constexpr Matrix<4, 4, double, UncheckedAccess> matrix {
+		-5.0,  2.0,  6.0, -8.0,
+		 1.0, -5.0,  1.0,  8.0,
+		 7.0,  7.0, -6.0, -7.0,
+		 1.0, -3.0,  7.0,  4.0
+	};
+	constexpr Matrix<4, 4, double, UncheckedAccess> expected {
+		 0.218045,  0.451128,  0.240602, -0.045113,
+		-0.808271, -1.456767, -0.443609,  0.520677,
+		-0.078947, -0.223684, -0.052632,  0.197368,
+		-0.522556, -0.813910, -0.300752,  0.306391
+	};
+	ASSERT_EQUAL(expected, cofactorInverse(matrix));
+	ASSERT_EQUAL(expected, inverse(matrix));
+}
+
+constexpr Matrix<6, 6> sixBySix {
+	 2.0, -1.0,  0.0,  3.0,  1.0, -2.0,
+	 4.0,  1.0, -3.0,  0.0,  2.0,  1.0,
+	-1.0,  5.0,  2.0, -2.0,  0.0,  3.0,
+	 0.0,  2.0,  1.0,  4.0, -3.0,  1.0,
+	 3.0,  0.0, -1.0,  1.0,  5.0, -4.0,
+	 1.0, -2.0,  4.0,  2.0,  1.0,  6.0
+};
+
+void testLUDeterminantMatchesCofactorExpansion() {
+	constexpr auto result = determinant(sixBySix);
+	ASSERT_EQUAL_DELTA(cofactorDeterminant(sixBySix), result, 0.000001);
+}
+
+void testLUInverseMatchesCofactorInverse() {
+	constexpr auto result = inverse(sixBySix);
+	ASSERT_EQUAL(cofactorInverse(sixBySix), result);
+	ASSERT_EQUAL(identity<6>, sixBySix * result);
+}
+
+void testLUDecompositionRequiresPivoting() {
+	constexpr Matrix<5, 5> matrix {
+		0.0, 1.0, 0.0, 0.0, 0.0,
+		1.0, 0.0, 0.0, 0.0, 0.0,
+		0.0, 0.0, 0.0, 0.0, 2.0,
+		0.0, 0.0, 3.0, 0.0, 0.0,
+		0.0, 0.0, 0.0, 4.0, 0.0
+	};
+	constexpr auto decomposition = luDecompose(matrix);
+	ASSERT(!decomposition.singular);
+	ASSERT_EQUAL(cofactorDeterminant(matrix), determinant(decomposition));
+	ASSERT_EQUAL(identity<5>, matrix * inverse(decomposition));
+}
+
+void testSolveLinearSystem() {
+	constexpr Matrix<6, 1> expected{1.0, -2.0, 3.0, 0.5, -1.5, 2.0};
+	constexpr auto rhs = sixBySix * expected;
+	constexpr auto result = solve(luDecompose(sixBySix), rhs);
+	ASSERT_EQUAL(expected, result);
+}
+
+void testLUOfSingularMatrix() {
+	constexpr Matrix<5, 5> matrix {
+		1.0, 2.0, 3.0, 4.0, 5.0,
+		2.0, 4.0, 6.0, 8.0, 10.0,
+		0.0, 1.0, 0.0, 1.0, 0.0,
+		1.0, 0.0, 1.0, 0.0, 1.0,
+		3.0, 3.0, 3.0, 3.0, 3.0
+	};
+	constexpr auto decomposition = luDecompose(matrix);
+	ASSERT(decomposition.singular);
+	ASSERT_EQUAL(0.0, determinant(matrix));
+	ASSERT(!invertible(matrix));
+	ASSERT_THROWS(inverse(matrix), std::invalid_argument);
+	ASSERT_THROWS(solve(decomposition, Matrix<5, 1>{}), std::invalid_argument);
+}
+
+void testLUWithSmallPivotIsNotSingular() {
+	constexpr Matrix<5, 5> matrix {
+		1e-7, 0.0, 0.0, 0.0, 0.0,
+		0.0, 1e7, 0.0, 0.0, 0.0,
+		0.0, 0.0, 1.0, 0.0, 0.0,
+		0.0, 0.0, 0.0, 1.0, 0.0,
+		0.0, 0.0, 0.0, 0.0, 1.0
+	};
+	ASSERT(!luDecompose(matrix).singular);
+	ASSERT_EQUAL_DELTA(cofactorDeterminant(matrix), determinant(matrix), 1e-12);
+	ASSERT(invertible(matrix));
+	ASSERT_EQUAL(identity<5>, matrix * inverse(matrix));
+}
+
+void testLUInverseOfLargeMatrixAtCompileTime() {
+	constexpr auto matrix = [] {
+		auto result = identity<10>;
+		for (auto row = 0u; row < 10; ++row) {
+			for (auto column = 0u; column < 10; ++column) {
+				result[Row{row}, Column{column}] += 1.0 / (1.0 + row + 2 * column);
+			}
+		}
+		return result;
+	}();
+	constexpr auto result = inverse(matrix);
+	ASSERT_EQUAL(identity<10>, matrix * result);
+}
+
 cute::suite make_suite_MatrixTestSuite() {
 	cute::suite s { };
 	s.push_back(CUTE(testDefaultMatrixIsAllZero));
@@ -507,5 +737,22 @@ cute::suite make_suite_MatrixTestSuite() {
 	s.push_back(CUTE(testMultiplyByInverse));
 	s.push_back(CUTE(testInverseOfTransposeIsTransposeOfInverse));
 	s.push_back(CUTE(testEffectOfModifiedIdentity));
+	s.push_back(CUTE(testClosedFormDeterminantMatchesCofactorExpansion));
+	s.push_back(CUTE(testClosedFormThreeByThreeDeterminantMatchesCofactorExpansion));
+	s.push_back(CUTE(testClosedFormInverseMatchesCofactorInverse));
+	s.push_back(CUTE(testInverseOfThreeByThree));
+	s.push_back(CUTE(testInverseOfThreeByThreeWithDeterminantZeroThrows));
+	s.push_back(CUTE(testMultiplyKernelsMatchGenericProduct));
+	s.push_back(CUTE(testRuntimeProductMatchesCompileTimeProduct));
+	s.push_back(CUTE(testCompileTimeIndexedAccess));
+	s.push_back(CUTE(testCheckedAccessThrowsOutsideOfMatrix));
+	s.push_back(CUTE(testUncheckedAccessComputesSameInverse));
+	s.push_back(CUTE(testLUDeterminantMatchesCofactorExpansion));
+	s.push_back(CUTE(testLUInverseMatchesCofactorInverse));
+	s.push_back(CUTE(testLUDecompositionRequiresPivoting));
+	s.push_back(CUTE(testSolveLinearSystem));
+	s.push_back(CUTE(testLUOfSingularMatrix));
+	s.push_back(CUTE(testLUWithSmallPivotIsNotSingular));
+	s.push_back(CUTE(testLUInverseOfLargeMatrixAtCompileTime));
 	return s;
 }
@@ -0,0 +1,127 @@
+#include "PrecisionTestSuite.h"
+#include "cute.h"
+#include "Direction.h"
+#include "DoubleComparison.h"
+#include "Intersections.h"
+#include "Light.h"
+#include "Material.h"
+#include "Point.h"
+#include "Ray.h"
+#include "Sphere.h"
+#include "Transformations.h"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <string>
+
+
+template <typename T>
+void testNormalizedDirectionHasUnitMagnitude() {
+	constexpr BasicDirection<T> direction{T(1), T(2), T(3)};
+	constexpr auto normalized = normalize(direction);
+	ASSERT(isEqual(magnitude(normalized), T(1)));
+}
+
+template <typename T>
+void testRayIntersectsScaledSphere() {
+	constexpr BasicRay<T> ray{BasicPoint<T>{T(0), T(0), T(-5)}, BasicDirection<T>{T(0), T(0), T(1)}};
+	constexpr Shapes::BasicSphere<T> sphere{{}, scaling(T(2), T(2), T(2))};
+	constexpr auto result = intersect(sphere, ray);
+	ASSERT_EQUAL(2, result.count);
+	ASSERT(isEqual(result[0].time, T(3)));
+	ASSERT(isEqual(result[1].time, T(7)));
+}
+
+template <typename T>
+void testHitIgnoresNegativeIntersections() {
+	constexpr ShapeId sphere{3};
+	constexpr BasicIntersection<T> behind{T(-1), sphere};
+	constexpr BasicIntersection<T> ahead{T(2), sphere};
+	constexpr auto inters = intersections(behind, ahead);
+	constexpr auto firstHit = hit(inters);
+	ASSERT(firstHit.has_value());
+	ASSERT_EQUAL(ahead, *firstHit);
+}
+
+template <typename T>
+void testNormalOnTranslatedSphere() {
+	constexpr Shapes::BasicSphere<T> sphere{{}, translation(T(0), T(1), T(0))};
+	constexpr auto halfSqrtTwo = std::sqrt(T(2)) / T(2);
+	constexpr BasicPoint<T> surfacePoint{T(0), T(1) + halfSqrtTwo, -halfSqrtTwo};
+	constexpr BasicDirection<T> expected{T(0), halfSqrtTwo, -halfSqrtTwo};
+	ASSERT_EQUAL(expected, normalAt(sphere, surfacePoint));
+}
+
+template <typename T>
+void testLightingWithEyeBetweenLightAndSurface() {
+	constexpr auto material = basicDefaultMaterial<T>;
+	constexpr BasicPoint<T> position{};
+	constexpr BasicDirection<T> eye{T(0), T(0), T(-1)};
+	constexpr BasicDirection<T> normal{T(0), T(0), T(-1)};
+	constexpr auto light = pointLight(BasicPoint<T>{T(0), T(0), T(-10)}, BasicColor<T>{T(1), T(1), T(1)});
+	constexpr BasicColor<T> expected{T(1.9), T(1.9), T(1.9)};
+	ASSERT_EQUAL(expected, lighting(material, light, position, eye, normal));
+}
+
+// A unit sphere so far away that the textbook discriminant b^2 - 4ac is
+// lost in the rounding of its two terms near the silhouette.
+template <typename T>
+void testRayGrazesDistantSphere() {
+	auto const distance = std::sqrt(T(1) / std::numeric_limits<T>::epsilon());
+	auto const offset = T(0.999);
+	BasicRay<T> const ray{BasicPoint<T>{offset, T(0), T(0)}, BasicDirection<T>{T(0), T(0), T(1)}};
+	Shapes::BasicSphere<T> const sphere{{}, translation(T(0), T(0), distance)};
+	auto const result = intersect(sphere, ray);
+	auto const halfChord = std::sqrt(T(1) - offset * offset);
+	auto const tolerance = 8 * distance * std::numeric_limits<T>::epsilon();
+	ASSERT_EQUAL(2, result.count);
+	ASSERT_EQUAL_DELTA(distance - halfChord, result[0].time, tolerance);
+	ASSERT_EQUAL_DELTA(distance + halfChord, result[1].time, tolerance);
+}
+
+namespace {
+
+template <typename T>
+BasicColor<T> shadePixel(std::size_t const column) {
+	BasicLight<T> const light{{T(-10), T(-10), T(-10)}, BasicColor<T>{Colors::white}};
+	Shapes::BasicSphere<T> const sphere{{}, scaling(T(1), T(1), T(1))};
+	BasicPoint<T> const eye{T(0), T(0), T(-5)};
+	BasicPoint<T> const canvasPoint{T(-1.5) + T(3) * static_cast<T>(column) / T(32), T(0.25), T(0)};
+	BasicRay<T> const ray{eye, normalize(canvasPoint - eye)};
+	auto const result = intersect(sphere, ray);
+	auto const firstHit = hit(result.times, result.count);
+	if (!firstHit) {
+		return BasicColor<T>{Colors::black};
+	}
+	auto const position = ray.position(firstHit->time);
+	auto const normal = normalAt(sphere, position);
+	return lighting(sphere.material, light, position, -ray.direction, normal);
+}
+
+}
+
+void testSinglePrecisionShadingMatchesDoublePrecision() {
+	for (auto column = 0u; column <= 32u; ++column) {
+		ColorF const expected{shadePixel<double>(column)};
+		ASSERT_EQUALM("column " + std::to_string(column), expected, shadePixel<float>(column));
+	}
+}
+
+cute::suite make_suite_PrecisionTestSuite() {
+	cute::suite s { };
+	s.push_back(CUTE(testNormalizedDirectionHasUnitMagnitude<float>));
+	s.push_back(CUTE(testNormalizedDirectionHasUnitMagnitude<double>));
+	s.push_back(CUTE(testRayIntersectsScaledSphere<float>));
+	s.push_back(CUTE(testRayIntersectsScaledSphere<double>));
+	s.push_back(CUTE(testHitIgnoresNegativeIntersections<float>));
+	s.push_back(CUTE(testHitIgnoresNegativeIntersections<double>));
+	s.push_back(CUTE(testNormalOnTranslatedSphere<float>));
+	s.push_back(CUTE(testNormalOnTranslatedSphere<double>));
+	s.push_back(CUTE(testLightingWithEyeBetweenLightAndSurface<float>));
+	s.push_back(CUTE(testLightingWithEyeBetweenLightAndSurface<double>));
+	s.push_back(CUTE(testRayGrazesDistantSphere<float>));
+	s.push_back(CUTE(testRayGrazesDistantSphere<double>));
+	s.push_back(CUTE(testSinglePrecisionShadingMatchesDoublePrecision));
+	return s;
+}
@@ -0,0 +1,8 @@
+#ifndef PRECISIONTESTSUITE_H_
+#define PRECISIONTESTSUITE_H_
+
+#include "cute_suite.h"
+
+extern cute::suite make_suite_PrecisionTestSuite();
+
+#endif /* PRECISIONTESTSUITE_H_ */
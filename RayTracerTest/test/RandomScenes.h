@@ -0,0 +1,66 @@
+#ifndef RANDOMSCENES_H_
+#define RANDOMSCENES_H_
+
+#include "Point.h"
+#include "Ray.h"
+#include "Span.h"
+#include "Sphere.h"
+#include "Transform.h"
+#include "Transformations.h"
+#include "World.h"
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+
+// Scenes of many spheres for the tests and benchmarks of accelerators and
+// batched kernels. The same seed gives the same scene on every run.
+
+// Spheres with radii in [minimumRadius, maximumRadius) whose centers lie
+// in the cube from -extent to extent.
+inline World randomSphereWorld(std::size_t const count, unsigned const seed, double const extent = 20.0, double const minimumRadius = 0.2, double const maximumRadius = 1.5) {
+	std::mt19937 generator{seed};
+	std::uniform_real_distribution<double> position{-extent, extent};
+	std::uniform_real_distribution<double> radius{minimumRadius, maximumRadius};
+	World world{};
+	for (std::size_t index = 0; index < count; ++index) {
+		auto const r = radius(generator);
+		world.add(Shapes::Sphere{{}, translation(position(generator), position(generator), position(generator)) * scaling(r, r, r)});
+	}
+	return world;
+}
+
+// Rays from the plane z = originZ towards points in the cube from -extent
+// to extent.
+template <typename T = double>
+std::vector<BasicRay<T>> randomRays(std::size_t const count, unsigned const seed, NonDeduced<T> const extent = T(25), NonDeduced<T> const originZ = T(-40)) {
+	std::mt19937 generator{seed};
+	std::uniform_real_distribution<T> coordinate{-extent, extent};
+	std::vector<BasicRay<T>> rays{};
+	for (std::size_t index = 0; index < count; ++index) {
+		BasicPoint<T> const origin{coordinate(generator), coordinate(generator), originZ};
+		BasicPoint<T> const target{coordinate(generator), coordinate(generator), coordinate(generator)};
+		rays.push_back(BasicRay<T>{origin, normalize(target - origin)});
+	}
+	return rays;
+}
+
+// Spheres in the cube from -extent to extent, every stretchEvery-th one
+// stretched along y so that its transform is not a similarity.
+template <typename T>
+std::vector<Shapes::BasicSphere<T>> randomSpheres(std::size_t const count, unsigned const seed, T const extent, std::size_t const stretchEvery) {
+	std::mt19937 generator{seed};
+	std::uniform_real_distribution<T> position{-extent, extent};
+	std::uniform_real_distribution<T> scale{T(0.2), T(1.5)};
+	std::vector<Shapes::BasicSphere<T>> spheres{};
+	for (std::size_t index = 0; index < count; ++index) {
+		auto const x = scale(generator);
+		auto const stretch = index % stretchEvery ? x : scale(generator);
+		spheres.push_back(Shapes::BasicSphere<T>{{}, BasicTransform<T>{translation(position(generator), position(generator), position(generator)) * scaling(x, stretch, x)}});
+	}
+	return spheres;
+}
+
+
+#endif /* RANDOMSCENES_H_ */
@@ -0,0 +1,157 @@
+#include "RayPacketTestSuite.h"
+#include "Intersections.h"
+#include "Light.h"
+#include "Occlusion.h"
+#include "Point.h"
+#include "RandomScenes.h"
+#include "Ray.h"
+#include "RayPacket.h"
+#include "Sphere.h"
+#include "Transform.h"
+#include "Transformations.h"
+#include "World.h"
+#include "cute.h"
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+
+namespace {
+
+template <typename T, std::size_t N>
+std::vector<BasicRayPacket<T, N>> randomPackets(std::size_t const count, unsigned const seed) {
+	std::mt19937 generator{seed};
+	std::uniform_real_distribution<T> coordinate{-6, 6};
+	std::vector<BasicRayPacket<T, N>> packets(count);
+	for (auto & packet : packets) {
+		for (std::size_t lane = 0; lane < N; ++lane) {
+			BasicPoint<T> const origin{coordinate(generator), coordinate(generator), coordinate(generator)};
+			BasicPoint<T> const target{coordinate(generator), coordinate(generator), coordinate(generator)};
+			packet.set(lane, BasicRay<T>{origin, normalize(target - origin)});
+		}
+	}
+	return packets;
+}
+
+template <typename T, std::size_t N>
+void assertPacketIntersectionMatchesHitTime(T const delta) {
+	// Half of the spheres are stretched, so both paths of the kernel are taken.
+	auto const spheres = randomSpheres<T>(20, 1, T(5), 2);
+	for (auto const & packet : randomPackets<T, N>(50, 2)) {
+		for (auto const & sphere : spheres) {
+			std::array<T, N> tMax{};
+			tMax.fill(T(6));
+			std::array<T, N> times{};
+			times.fill(T(-1));
+			auto const mask = intersect(sphere, packet, tMax, times);
+			for (std::size_t lane = 0; lane < N; ++lane) {
+				auto const expected = hitTime(sphere, packet[lane], tMax[lane]);
+				ASSERT_EQUAL(expected.has_value(), ((mask >> lane) & 1u) != 0);
+				ASSERT_EQUAL_DELTA(expected.value_or(T(-1)), times[lane], delta);
+			}
+		}
+	}
+}
+
+}
+
+void testPacketLanesHoldRays() {
+	RayPacket4 packet{};
+	Ray const ray{{1.0, 2.0, 3.0}, {0.0, -1.0, 0.0}};
+	packet.set(2, ray);
+	ASSERT_EQUAL(ray, packet[2]);
+	ASSERT_EQUAL(Ray{}, packet[1]);
+	ASSERT_EQUAL(8u, RayPacket8F::kWidth);
+}
+
+void testPacketIntersectionMatchesHitTimeDouble() {
+	assertPacketIntersectionMatchesHitTime<double, 4>(1e-12);
+	assertPacketIntersectionMatchesHitTime<double, 8>(1e-12);
+}
+
+void testPacketIntersectionMatchesHitTimeFloat() {
+	assertPacketIntersectionMatchesHitTime<float, 4>(1e-4f);
+	assertPacketIntersectionMatchesHitTime<float, 8>(1e-4f);
+}
+
+void testPacketIntersectionFromInsideAndBehind() {
+	RayPacket4 packet{};
+	packet.set(0, Ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}});
+	packet.set(1, Ray{{0.0, 0.0, 0.0}, {0.0, 0.0, 1.0}});
+	packet.set(2, Ray{{0.0, 0.0, 5.0}, {0.0, 0.0, 1.0}});
+	packet.set(3, Ray{{0.0, 2.0, -5.0}, {0.0, 0.0, 1.0}});
+	std::array<double, 4> tMax{};
+	tMax.fill(std::numeric_limits<double>::infinity());
+	std::array<double, 4> times{};
+	ASSERT_EQUAL(0b0011u, intersect(Shapes::Sphere{}, packet, tMax, times));
+	ASSERT_EQUAL((std::array<double, 4>{4.0, 1.0, 0.0, 0.0}), times);
+}
+
+void testPacketHitMatchesNearestOfShapes() {
+	World world{};
+	for (auto const & sphere : randomSpheres<double>(30, 3, 5.0, 2)) {
+		world.add(sphere);
+	}
+	auto const & spheres = world.scene().spheres();
+	for (auto const & packet : randomPackets<double, 8>(50, 4)) {
+		auto const hits = hit(spheres, packet);
+		for (std::size_t lane = 0; lane < 8; ++lane) {
+			auto const expected = world.hit(packet[lane]);
+			ASSERT_EQUAL(expected.has_value(), ((hits.mask >> lane) & 1u) != 0);
+			if (expected) {
+				ASSERT_EQUAL_DELTA(expected->time, hits.time[lane], 1e-12);
+				ASSERT_EQUAL(expected->shape, hits.shape[lane]);
+			} else {
+				ASSERT(hits.time[lane] == std::numeric_limits<double>::infinity());
+			}
+		}
+	}
+}
+
+void testPacketOcclusionMatchesIsOccluded() {
+	auto const spheres = randomSpheres<double>(30, 5, 5.0, 2);
+	constexpr Light light{{0.0, 20.0, 0.0}, Colors::white};
+	std::mt19937 generator{6};
+	std::uniform_real_distribution<double> coordinate{-6.0, 6.0};
+	std::array<double, 4> maxTime{};
+	maxTime.fill(1.0);
+	for (auto iteration = 0; iteration < 100; ++iteration) {
+		RayPacket4 packet{};
+		std::array<Point, 4> points{};
+		for (std::size_t lane = 0; lane < 4; ++lane) {
+			points[lane] = Point{coordinate(generator), coordinate(generator), coordinate(generator)};
+			packet.set(lane, shadowRay(points[lane], light));
+		}
+		auto const all = occluded(spheres, packet, maxTime);
+		for (std::size_t lane = 0; lane < 4; ++lane) {
+			ASSERT_EQUAL(isOccluded(spheres, points[lane], light), ((all >> lane) & 1u) != 0);
+		}
+		ASSERT_EQUAL(all & 0b0101u, occluded(spheres, packet, maxTime, 0b0101u));
+	}
+}
+
+void testPacketWithSingularTransformThrows() {
+	std::vector<Shapes::Sphere> const shapes{Shapes::Sphere{{}, scaling(1.0, 0.0, 1.0)}, Shapes::Sphere{}};
+	auto const packet = randomPackets<double, 4>(1, 3).front();
+	std::array<double, 4> maxTime{};
+	maxTime.fill(1.0);
+	ASSERT_THROWS(intersect(shapes.front(), packet, maxTime, maxTime), std::invalid_argument);
+	ASSERT_THROWS(hit(shapes, packet), std::invalid_argument);
+	ASSERT_THROWS(occluded(shapes, packet, maxTime), std::invalid_argument);
+}
+
+cute::suite make_suite_RayPacketTestSuite() {
+	cute::suite s { };
+	s.push_back(CUTE(testPacketLanesHoldRays));
+	s.push_back(CUTE(testPacketIntersectionMatchesHitTimeDouble));
+	s.push_back(CUTE(testPacketIntersectionMatchesHitTimeFloat));
+	s.push_back(CUTE(testPacketIntersectionFromInsideAndBehind));
+	s.push_back(CUTE(testPacketHitMatchesNearestOfShapes));
+	s.push_back(CUTE(testPacketOcclusionMatchesIsOccluded));
+	s.push_back(CUTE(testPacketWithSingularTransformThrows));
+	return s;
+}
@@ -0,0 +1,8 @@
+#ifndef RAYPACKETTESTSUITE_H_
+#define RAYPACKETTESTSUITE_H_
+
+#include "cute_suite.h"
+
+extern cute::suite make_suite_RayPacketTestSuite();
+
+#endif /* RAYPACKETTESTSUITE_H_ */
@@ -3,10 +3,15 @@
 #include "Direction.h"
 #include "Intersections.h"
 #include "Point.h"
+#include "Scene.h"
 #include "Sphere.h"
 #include "Transformations.h"
 #include "cute.h"
 
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 #include <tuple>
 
 
@@ -54,7 +59,7 @@ void testRayPosition() {
 void testRayIntersectionWithSphere() {
 	constexpr Ray ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}};
 	constexpr Sphere sphere{};
-	constexpr IntersectionResult expected{sphere, 4.0, 6.0};
+	constexpr IntersectionResult expected{ShapeId{}, 4.0, 6.0};
 	constexpr auto intersections = intersect(sphere, ray);
 	ASSERT_EQUAL(expected, intersections);
 }
@@ -62,7 +67,7 @@ void testRayIntersectionWithSphere() {
 void testRayTouchesSphere() {
 	constexpr Ray ray{{0.0, 1.0, -5.0}, {0.0, 0.0, 1.0}};
 	constexpr Sphere sphere{};
-	constexpr IntersectionResult expected{sphere, 5.0, 5.0};
+	constexpr IntersectionResult expected{ShapeId{}, 5.0, 5.0};
 	constexpr auto intersections = intersect(sphere, ray);
 	ASSERT_EQUAL(expected, intersections);
 }
@@ -78,7 +83,7 @@ void testRayMissesSphere() {
 void testRayOriginsInSphere() {
 	constexpr Ray ray{{0.0, 0.0, 0.0}, {0.0, 0.0, 1.0}};
 	constexpr Sphere sphere{};
-	constexpr IntersectionResult expected{sphere, -1.0, 1.0};
+	constexpr IntersectionResult expected{ShapeId{}, -1.0, 1.0};
 	constexpr auto intersections = intersect(sphere, ray);
 	ASSERT_EQUAL(expected, intersections);
 }
@@ -86,13 +91,13 @@ void testRayOriginsInSphere() {
 void testRayOriginsBeyonSphere() {
 	constexpr Ray ray{{0.0, 0.0, 5.0}, {0.0, 0.0, 1.0}};
 	constexpr Sphere sphere{};
-	constexpr IntersectionResult expected{sphere, -6.0, -4.0};
+	constexpr IntersectionResult expected{ShapeId{}, -6.0, -4.0};
 	constexpr auto intersections = intersect(sphere, ray);
 	ASSERT_EQUAL(expected, intersections);
 }
 
 void testIntersectionsStructure() {
-	constexpr Sphere sphere{};
+	constexpr ShapeId sphere{7};
 	constexpr Intersection i1{1.0, sphere};
 	constexpr Intersection i2{2.0, sphere};
 	constexpr auto intersects = intersections(i1, i2);
@@ -103,12 +108,28 @@ void testIntersectionsStructure() {
 void testIntersectObjectContent() {
 	constexpr Ray ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}};
 	constexpr Sphere sphere{};
-	constexpr auto inters = intersect(sphere, ray);
-	ASSERT_EQUAL(std::tie(sphere, sphere), std::tie(std::get<Sphere>(inters[0].object), std::get<Sphere>(inters[1].object)));
+	Scene scene{};
+	scene.add(Sphere{{1.0, 0.0, 0.0}});
+	auto const id = scene.add(sphere);
+	auto const inters = scene.intersect(id, ray);
+	ASSERT_EQUAL(std::tie(id, id), std::tie(inters[0].shape, inters[1].shape));
+	ASSERT_EQUAL(sphere, scene[inters[0].shape]);
+}
+
+void testIntersectionRefersToShapeByHandle() {
+	ASSERT_EQUAL(4u, sizeof(ShapeId));
+	ASSERT_EQUAL(16u, sizeof(Intersection));
+	ASSERT_EQUAL(8u, sizeof(IntersectionF));
+}
+
+void testSceneRejectsUnknownShapeId() {
+	Scene scene{};
+	scene.add(Sphere{});
+	ASSERT_THROWS(scene[ShapeId{1}], std::invalid_argument);
 }
 
 void testHitWithPositiveTime() {
-	constexpr Sphere sphere{};
+	constexpr ShapeId sphere{7};
 	constexpr Intersection i1{1.0, sphere};
 	constexpr Intersection i2{2.0, sphere};
 	constexpr auto inters = intersections(i1, i2);
@@ -117,7 +138,7 @@ void testHitWithPositiveTime() {
 }
 
 void testHitWithMixedTime() {
-	constexpr Sphere sphere{};
+	constexpr ShapeId sphere{7};
 	constexpr Intersection i1{-1.0, sphere};
 	constexpr Intersection i2{1.0, sphere};
 	constexpr auto inters = intersections(i1, i2);
@@ -126,7 +147,7 @@ void testHitWithMixedTime() {
 }
 
 void testHitWithNegativeTime() {
-	constexpr Sphere sphere{};
+	constexpr ShapeId sphere{7};
 	constexpr Intersection i1{-2.0, sphere};
 	constexpr Intersection i2{-1.0, sphere};
 	constexpr auto inters = intersections(i1, i2);
@@ -135,7 +156,7 @@ void testHitWithNegativeTime() {
 }
 
 void testHitReturnsLowestNonNegativeTime() {
-	constexpr Sphere sphere{};
+	constexpr ShapeId sphere{7};
 	constexpr Intersection i1{5.0, sphere};
 	constexpr Intersection i2{7.0, sphere};
 	constexpr Intersection i3{-3.0, sphere};
@@ -159,6 +180,51 @@ void testIntersetingATranslatedSphereWithARay() {
 	ASSERT_EQUAL(intersectResult.count, 0);
 }
 
+void testHitTimeIgnoresSphereBehindOrigin() {
+	constexpr Ray ray{{0.0, 0.0, 5.0}, {0.0, 0.0, 1.0}};
+	constexpr auto time = hitTime(Sphere{}, ray);
+	ASSERT(!time.has_value());
+}
+
+void testHitTimeFromInsideSphere() {
+	constexpr Ray ray{{0.0, 0.0, 0.0}, {0.0, 0.0, 1.0}};
+	constexpr auto time = hitTime(Sphere{}, ray);
+	ASSERT_EQUAL(1.0, time.value());
+}
+
+void testHitTimeBeyondMaximum() {
+	constexpr Ray ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}};
+	ASSERT_EQUAL(4.0, hitTime(Sphere{}, ray, 4.5).value());
+	ASSERT(!hitTime(Sphere{}, ray, 4.0).has_value());
+}
+
+void testPrecomputedRay() {
+	PrecomputedRay const ray{Ray{{1, 2, 3}, {2, -4, 0}}, 1.0, 10.0};
+	ASSERT_EQUAL(0.5, ray.inverseDirection.x);
+	ASSERT_EQUAL(-0.25, ray.inverseDirection.y);
+	ASSERT(ray.inverseDirection.z == std::numeric_limits<double>::infinity());
+	ASSERT_EQUAL((std::array<std::uint8_t, 3>{0, 1, 0}), ray.sign);
+	ASSERT_EQUAL(2u, ray.octant());
+	ASSERT_EQUAL(1.0, ray.tMin);
+	ASSERT_EQUAL(10.0, ray.tMax);
+}
+
+void testPrecomputedRaySignOfNegativeZero() {
+	PrecomputedRay const ray{Ray{{}, {-0.0, 0.0, -1.0}}};
+	ASSERT_EQUAL(5u, ray.octant());
+}
+
+void testTransformedPrecomputedRayKeepsInterval() {
+	PrecomputedRay const ray{Ray{{1, 2, 3}, {0, 1, 0}}, 0.5, 4.0};
+	auto const transformed = ray.transform(scaling(2.0, -3.0, 4.0));
+	ASSERT_EQUAL((Point{2, -6, 12}), transformed.origin);
+	ASSERT_EQUAL((Direction{0, -3, 0}), transformed.direction);
+	ASSERT_EQUAL_DELTA(-1.0 / 3.0, transformed.inverseDirection.y, 1e-15);
+	ASSERT_EQUAL(2u, transformed.octant());
+	ASSERT_EQUAL(0.5, transformed.tMin);
+	ASSERT_EQUAL(4.0, transformed.tMax);
+}
+
 cute::suite make_suite_RayTestSuite() {
 	cute::suite s { };
 	s.push_back(CUTE(testPropertiesOfRay));
@@ -170,6 +236,8 @@ cute::suite make_suite_RayTestSuite() {
 	s.push_back(CUTE(testRayOriginsBeyonSphere));
 	s.push_back(CUTE(testIntersectionsStructure));
 	s.push_back(CUTE(testIntersectObjectContent));
+	s.push_back(CUTE(testIntersectionRefersToShapeByHandle));
+	s.push_back(CUTE(testSceneRejectsUnknownShapeId));
 	s.push_back(CUTE(testHitWithPositiveTime));
 	s.push_back(CUTE(testHitWithMixedTime));
 	s.push_back(CUTE(testHitWithNegativeTime));
@@ -178,5 +246,11 @@ cute::suite make_suite_RayTestSuite() {
 	s.push_back(CUTE(testRayInequality));
 	s.push_back(CUTE(testIntersetingAScaledSphereWithARay));
 	s.push_back(CUTE(testIntersetingATranslatedSphereWithARay));
+	s.push_back(CUTE(testHitTimeIgnoresSphereBehindOrigin));
+	s.push_back(CUTE(testHitTimeFromInsideSphere));
+	s.push_back(CUTE(testHitTimeBeyondMaximum));
+	s.push_back(CUTE(testPrecomputedRay));
+	s.push_back(CUTE(testPrecomputedRaySignOfNegativeZero));
+	s.push_back(CUTE(testTransformedPrecomputedRayKeepsInterval));
 	return s;
 }
@@ -1,21 +1,26 @@
 #include "ShapesTestSuite.h"
 #include "cute.h"
 
+#include "Intersections.h"
 #include "Pi.h"
+#include "Ray.h"
 #include "Sphere.h"
 #include "Transformations.h"
 
+#include <cmath>
+#include <random>
+
 using namespace Shapes;
 
 void testDefaultInitializedSphere() {
 	constexpr Sphere sphere{};
-	ASSERT_EQUAL(identity<4>, sphere.transform);
+	ASSERT_EQUAL(identity<4>, sphere.transform.matrix());
 }
 
 void testSphereWithCustomTransform() {
 	constexpr Matrix<4, 4> expected{2, 3, 4};
 	constexpr Sphere sphere{{}, expected};
-	ASSERT_EQUAL(expected, sphere.transform);
+	ASSERT_EQUAL(expected, sphere.transform.matrix());
 }
 
 void testNormalOnSphereOnXAxis() {
@@ -83,7 +88,95 @@ void testAssignmentOfpSphereMaterial() {
 	ASSERT_EQUAL(sphereMaterial, sphere.material);
 }
 
+void testObjectBoundsOfSphere() {
+	constexpr Sphere sphere{{1.0, 2.0, 3.0}, scaling(5.0, 5.0, 5.0)};
+	constexpr auto box = objectBounds(sphere);
+	ASSERT_EQUAL((Point{0.0, 1.0, 2.0}), box.min);
+	ASSERT_EQUAL((Point{2.0, 3.0, 4.0}), box.max);
+}
+
+void testWorldBoundsOfRotatedEllipsoidAreTight() {
+	constexpr Sphere sphere{{}, translation(1.0, 0.0, 0.0) * rotation_z(pi<double> / 4) * scaling(2.0, 1.0, 1.0)};
+	constexpr auto box = bounds(sphere);
+	auto const halfExtent = std::sqrt(2.5);
+	ASSERT_EQUAL((Point{1.0 - halfExtent, -halfExtent, -1.0}), box.min);
+	ASSERT_EQUAL((Point{1.0 + halfExtent, halfExtent, 1.0}), box.max);
+	ASSERT(transformed(sphere.transform.matrix(), objectBounds(sphere)).contains(box));
+}
+
+void testWorldBoundsContainSurfaceOfTransformedSphere() {
+	constexpr Sphere sphere{{}, translation(3.0, -2.0, 1.0) * rotation_x(0.7) * shearing(0.5, 0.0, 0.2, 0.0, 0.0, 0.3) * scaling(1.0, 2.0, 0.5)};
+	constexpr auto box = bounds(sphere);
+	constexpr auto slack = 1e-9;
+	for (auto step = 0; step < 64; ++step) {
+		auto const theta = step * pi<double> / 32;
+		for (auto ring = 1; ring < 16; ++ring) {
+			auto const phi = ring * pi<double> / 16;
+			Point const objectPoint{std::sin(phi) * std::cos(theta), std::sin(phi) * std::sin(theta), std::cos(phi)};
+			auto const worldPoint = sphere.transform.matrix() * objectPoint;
+			ASSERT(worldPoint.x >= box.min.x - slack && worldPoint.x <= box.max.x + slack);
+			ASSERT(worldPoint.y >= box.min.y - slack && worldPoint.y <= box.max.y + slack);
+			ASSERT(worldPoint.z >= box.min.z - slack && worldPoint.z <= box.max.z + slack);
+		}
+	}
+}
 
+void testSphereUnderSimilarityIntersectsInWorldSpace() {
+	constexpr Sphere sphere{{}, translation(1.0, 2.0, 3.0) * rotation_y(0.4) * scaling(2.0, 2.0, 2.0)};
+	constexpr Ray ray{{1.0, 2.0, -7.0}, {0.0, 0.0, 2.0}};
+	constexpr auto quadratic = sphereQuadratic(sphere, ray);
+	ASSERT_EQUAL(4.0, quadratic.radiusSquared);
+	auto const result = intersect(sphere, ray);
+	ASSERT_EQUAL(2u, result.count);
+	ASSERT_EQUAL_DELTA(4.0, result[0].time, 1e-12);
+	ASSERT_EQUAL_DELTA(6.0, result[1].time, 1e-12);
+}
+
+void testSphereUnderSimilarityMatchesObjectSpace() {
+	std::mt19937 generator{5};
+	std::uniform_real_distribution<double> coordinate{-5.0, 5.0};
+	std::uniform_real_distribution<double> scale{0.2, 3.0};
+	for (auto index = 0; index < 200; ++index) {
+		auto const r = scale(generator);
+		Sphere const sphere{{}, translation(coordinate(generator), coordinate(generator), coordinate(generator)) * rotation_z(coordinate(generator)) * scaling(r, r, r)};
+		Ray const ray{{coordinate(generator), coordinate(generator), -10.0}, {coordinate(generator) / 10.0, coordinate(generator) / 10.0, 1.0}};
+		auto const worldSpace = intersect(sphere, ray);
+		double near{};
+		double far{};
+		auto const hits = solve(sphereQuadratic(sphere.position, 1.0, ray.toObjectSpace(sphere.transform)), near, far);
+		ASSERT_EQUAL(hits ? 2u : 0u, worldSpace.count);
+		if (hits) {
+			ASSERT_EQUAL_DELTA(near, worldSpace[0].time, 1e-9);
+			ASSERT_EQUAL_DELTA(far, worldSpace[1].time, 1e-9);
+			auto const point = ray.position(near);
+			auto const objectNormal = sphere.transform.inverse() * point - Point{0.0, 0.0, 0.0};
+			auto const expected = normalize(sphere.transform.inverseTranspose() * objectNormal);
+			auto const normal = normalAt(sphere, point);
+			ASSERT_EQUAL_DELTA(expected.x, normal.x, 1e-9);
+			ASSERT_EQUAL_DELTA(expected.y, normal.y, 1e-9);
+			ASSERT_EQUAL_DELTA(expected.z, normal.z, 1e-9);
+		}
+	}
+}
+
+void testNormalOnSphereWithPositionAgreesAcrossPaths() {
+	constexpr Point position{1.0, -2.0, 0.5};
+	Sphere const uniform{position, translation(0.5, 1.0, -1.0) * scaling(2.0, 2.0, 2.0)};
+	Sphere const stretched{position, translation(0.5, 1.0, -1.0) * scaling(2.0, 3.0, 0.5)};
+	ASSERT(uniform.transform.similarityScale() != 0.0);
+	ASSERT_EQUAL(0.0, stretched.transform.similarityScale());
+	auto const val = std::sqrt(3.0) / 3.0;
+	for (auto const & objectNormal : {Direction{1.0, 0.0, 0.0}, Direction{0.0, -1.0, 0.0}, Direction{val, val, -val}}) {
+		for (auto const & sphere : {uniform, stretched}) {
+			auto const point = sphere.transform.matrix() * (position + objectNormal);
+			auto const expected = normalize(sphere.transform.inverseTranspose() * objectNormal);
+			auto const normal = normalAt(sphere, point);
+			ASSERT_EQUAL_DELTA(expected.x, normal.x, 1e-12);
+			ASSERT_EQUAL_DELTA(expected.y, normal.y, 1e-12);
+			ASSERT_EQUAL_DELTA(expected.z, normal.z, 1e-12);
+		}
+	}
+}
 
 cute::suite make_suite_ShapesTestSuite() {
 	cute::suite s { };
@@ -98,5 +191,11 @@ cute::suite make_suite_ShapesTestSuite() {
 	s.push_back(CUTE(testNormalOnTransformedSphere));
 	s.push_back(CUTE(testDefaultMaterialOnSphere));
 	s.push_back(CUTE(testAssignmentOfpSphereMaterial));
+	s.push_back(CUTE(testObjectBoundsOfSphere));
+	s.push_back(CUTE(testWorldBoundsOfRotatedEllipsoidAreTight));
+	s.push_back(CUTE(testWorldBoundsContainSurfaceOfTransformedSphere));
+	s.push_back(CUTE(testSphereUnderSimilarityIntersectsInWorldSpace));
+	s.push_back(CUTE(testSphereUnderSimilarityMatchesObjectSpace));
+	s.push_back(CUTE(testNormalOnSphereWithPositionAgreesAcrossPaths));
 	return s;
 }
@@ -0,0 +1,87 @@
+#include "SphereBatchTestSuite.h"
+#include "Intersections.h"
+#include "Point.h"
+#include "RandomScenes.h"
+#include "Ray.h"
+#include "Sphere.h"
+#include "SphereBatch.h"
+#include "Transform.h"
+#include "Transformations.h"
+#include "cute.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+
+namespace {
+
+// The nearest hit over all spheres, one at a time.
+template <typename T>
+std::optional<BasicIntersection<T>> nearest(std::vector<Shapes::BasicSphere<T>> const & spheres, BasicRay<T> const & ray, T tMax) {
+	std::optional<BasicIntersection<T>> closest{};
+	for (std::uint32_t shape = 0; shape < spheres.size(); ++shape) {
+		if (auto const time = hitTime(spheres[shape], ray, tMax)) {
+			tMax = *time;
+			closest = BasicIntersection<T>{*time, ShapeId{shape}};
+		}
+	}
+	return closest;
+}
+
+template <typename T>
+void assertBatchHitMatchesSpheres(std::size_t const count, T const tMax, T const delta) {
+	// Every third sphere is stretched, so both groups of the batch are used.
+	auto const spheres = randomSpheres<T>(count, static_cast<unsigned>(count), T(10), 3);
+	BasicSphereBatch<T> const batch{spheres};
+	ASSERT_EQUAL(count, batch.size());
+	for (auto const & ray : randomRays<T>(300, 1, T(12), T(-24))) {
+		auto const expected = nearest(spheres, ray, tMax);
+		auto const actual = batch.hit(ray, tMax);
+		ASSERT_EQUAL(expected.has_value(), actual.has_value());
+		if (expected) {
+			ASSERT_EQUAL_DELTA(expected->time, actual->time, delta);
+			ASSERT_EQUAL(expected->shape, actual->shape);
+		}
+	}
+}
+
+}
+
+void testEmptyBatchIsNeverHit() {
+	SphereBatch const batch{};
+	ASSERT_EQUAL(0u, batch.size());
+	ASSERT(!batch.hit(Ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}}).has_value());
+}
+
+void testBatchHitFromInsideSphere() {
+	std::vector<Shapes::Sphere> const spheres{Shapes::Sphere{}, Shapes::Sphere{{}, translation(0.0, 0.0, 3.0)}};
+	SphereBatch const batch{spheres};
+	auto const result = batch.hit(Ray{{}, {0.0, 0.0, 1.0}});
+	ASSERT_EQUAL((Intersection{1.0, ShapeId{0}}), result.value());
+	ASSERT(!batch.hit(Ray{{}, {0.0, 0.0, 1.0}}, 1.0).has_value());
+}
+
+void testBatchHitMatchesSpheresDouble() {
+	for (auto const count : {1u, 7u, 8u, 13u, 100u}) {
+		assertBatchHitMatchesSpheres<double>(count, std::numeric_limits<double>::infinity(), 1e-12);
+	}
+	assertBatchHitMatchesSpheres<double>(100, 8.0, 1e-12);
+}
+
+void testBatchHitMatchesSpheresFloat() {
+	for (auto const count : {1u, 7u, 8u, 13u, 100u}) {
+		assertBatchHitMatchesSpheres<float>(count, std::numeric_limits<float>::infinity(), 1e-4f);
+	}
+}
+
+cute::suite make_suite_SphereBatchTestSuite() {
+	cute::suite s { };
+	s.push_back(CUTE(testEmptyBatchIsNeverHit));
+	s.push_back(CUTE(testBatchHitFromInsideSphere));
+	s.push_back(CUTE(testBatchHitMatchesSpheresDouble));
+	s.push_back(CUTE(testBatchHitMatchesSpheresFloat));
+	return s;
+}
@@ -0,0 +1,8 @@
+#ifndef SPHEREBATCHTESTSUITE_H_
+#define SPHEREBATCHTESTSUITE_H_
+
+#include "cute_suite.h"
+
+extern cute::suite make_suite_SphereBatchTestSuite();
+
+#endif /* SPHEREBATCHTESTSUITE_H_ */
@@ -5,6 +5,7 @@
 
 #include "PointTestSuite.h"
 #include "ApplicationTestSuite.h"
+#include "BenchmarkTestSuite.h"
 #include "DirectionTestSuite.h"
 #include "OperationsTestSuite.h"
 #include "ColorTestSuite.h"
@@ -16,6 +17,14 @@
 #include "ReflectionTestSuite.h"
 #include "ShapesTestSuite.h"
 #include "TransformationsTestSuite.h"
+#include "SphereBatchTestSuite.h"
+#include "RayPacketTestSuite.h"
+#include "InstancingTestSuite.h"
+#include "GridTestSuite.h"
+#include "BvhTestSuite.h"
+#include "WorldTestSuite.h"
+#include "BatchTransformTestSuite.h"
+#include "PrecisionTestSuite.h"
 
 
 
@@ -54,6 +63,9 @@ bool runAllTests(int argc, char const *argv[]) {
 	auto transformationsTestSuite = make_suite_TransformationsTestSuite();
 	success &= runner(transformationsTestSuite, "Transformations Test Suite");
 
+	auto batchTransformTestSuite = make_suite_BatchTransformTestSuite();
+	success &= runner(batchTransformTestSuite, "Batch Transform Test Suite");
+
 	auto rayTestSuite = make_suite_RayTestSuite();
 	success &= runner(rayTestSuite, "Ray Test Suite");
 
@@ -63,8 +75,32 @@ bool runAllTests(int argc, char const *argv[]) {
 	auto shapesTestSuite = make_suite_ShapesTestSuite();
 	success &= runner(shapesTestSuite, "Shapes Test Suite");
 
+	auto worldTestSuite = make_suite_WorldTestSuite();
+	success &= runner(worldTestSuite, "World Test Suite");
+
+	auto bvhTestSuite = make_suite_BvhTestSuite();
+	success &= runner(bvhTestSuite, "Bvh Test Suite");
+
+	auto gridTestSuite = make_suite_GridTestSuite();
+	success &= runner(gridTestSuite, "Grid Test Suite");
+
+	auto instancingTestSuite = make_suite_InstancingTestSuite();
+	success &= runner(instancingTestSuite, "Instancing Test Suite");
+
+	auto rayPacketTestSuite = make_suite_RayPacketTestSuite();
+	success &= runner(rayPacketTestSuite, "Ray Packet Test Suite");
+
+	auto sphereBatchTestSuite = make_suite_SphereBatchTestSuite();
+	success &= runner(sphereBatchTestSuite, "Sphere Batch Test Suite");
+
+	auto precisionTestSuite = make_suite_PrecisionTestSuite();
+	success &= runner(precisionTestSuite, "Precision Test Suite");
+
 	auto applicationTestSuite = make_suite_ApplicationTestSuite();
 	success &= runner(applicationTestSuite, "Application Test Suite");
+
+	auto benchmarkTestSuite = make_suite_BenchmarkTestSuite();
+	success &= runner(benchmarkTestSuite, "Benchmark Test Suite");
 
 	return success;
 }
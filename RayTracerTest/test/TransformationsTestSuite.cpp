@@ -1,6 +1,11 @@
 #include "TransformationsTestSuite.h"
+#include "AffineTransform.h"
 #include "Transformations.h"
 #include "Pi.h"
+#include "Ray.h"
+#include "Transform.h"
+#include "TransformChain.h"
+#include "Sphere.h"
 #include "cute.h"
 
 #include <cmath>
@@ -192,6 +197,165 @@ void testScalingARay() {
 	ASSERT_EQUAL(expected, result);
 }
 
+void testTransformCachesInverse() {
+	constexpr auto matrix = translation(1.0, 2.0, 3.0) * scaling(2.0, 2.0, 2.0);
+	constexpr Transform transform{matrix};
+	ASSERT_EQUAL(inverse(matrix), transform.inverse());
+}
+
+void testTransformCachesInverseTranspose() {
+	constexpr auto matrix = shearing(1.0, 0.0, 0.0, 0.0, 0.0, 0.0) * rotation_x(pi<double> / 4);
+	constexpr Transform transform{matrix};
+	ASSERT_EQUAL(transpose(inverse(matrix)), transform.inverseTranspose());
+}
+
+void testDefaultTransformIsIdentity() {
+	constexpr Transform transform{};
+	ASSERT_EQUAL(identity<4>, transform.inverse());
+}
+
+void testSingularTransformThrowsOnInverseAccess() {
+	constexpr Transform transform{scaling(1.0, 0.0, 1.0)};
+	ASSERT(!transform.invertible());
+	ASSERT_THROWS(transform.inverse(), std::invalid_argument);
+}
+
+void testRayToObjectSpace() {
+	constexpr Ray expected{{-2, -2, -2}, {0, 1, 0}};
+
+	constexpr Ray ray{{1, 2, 3}, {0, 1, 0}};
+	constexpr Transform transform{translation(3.0, 4.0, 5.0)};
+
+	constexpr Ray result = ray.toObjectSpace(transform);
+	ASSERT_EQUAL(expected, result);
+}
+
+void testAffineTransformRoundTripsMatrix() {
+	constexpr auto matrix = translation(1.0, 2.0, 3.0) * rotation_y(pi<double> / 3) * scaling(2.0, 3.0, 4.0);
+	constexpr AffineTransform affine{matrix};
+	ASSERT_EQUAL(matrix, affine.toMatrix());
+}
+
+void testAffineTransformRejectsProjectiveMatrix() {
+	constexpr Matrix<4, 4> matrix {
+		1.0, 0.0, 0.0, 0.0,
+		0.0, 1.0, 0.0, 0.0,
+		0.0, 0.0, 1.0, 0.0,
+		0.0, 0.0, 1.0, 0.0
+	};
+	ASSERT_THROWS(AffineTransform{matrix}, std::invalid_argument);
+}
+
+void testAffineTransformStoresTwelveValues() {
+	ASSERT_EQUAL(12 * sizeof(double), sizeof(AffineTransform));
+}
+
+void testAffineCompositionMatchesMatrixProduct() {
+	constexpr auto first = shearing(1.0, 0.5, 0.0, 0.0, 0.25, 0.0);
+	constexpr auto second = translation(-2.0, 4.0, 1.0) * rotation_x(pi<double> / 5);
+	constexpr auto composed = AffineTransform{second} * AffineTransform{first};
+	ASSERT_EQUAL(second * first, composed.toMatrix());
+}
+
+void testAffineTransformAppliedToPointAndDirection() {
+	constexpr auto matrix = translation(5.0, -3.0, 2.0) * rotation_z(pi<double> / 2) * scaling(2.0, 2.0, 2.0);
+	constexpr AffineTransform affine{matrix};
+	constexpr Point point{1.0, 2.0, 3.0};
+	constexpr Direction direction{1.0, 2.0, 3.0};
+	ASSERT_EQUAL(matrix * point, affine * point);
+	ASSERT_EQUAL(matrix * direction, affine * direction);
+}
+
+void testAffineInverseMatchesMatrixInverse() {
+	constexpr auto matrix = translation(5.0, -3.0, 2.0) * rotation_y(pi<double> / 7) * shearing(0.0, 1.0, 0.0, 0.0, 0.0, 2.0);
+	constexpr auto result = inverse(AffineTransform{matrix});
+	ASSERT_EQUAL(inverse(matrix), result.toMatrix());
+}
+
+void testAffineInverseOfSingularTransformThrows() {
+	constexpr AffineTransform affine{scaling(1.0, 0.0, 1.0)};
+	ASSERT_THROWS(inverse(affine), std::invalid_argument);
+}
+
+void testTransformingARayWithAffineTransform() {
+	constexpr Ray expected{{2, 6, 12}, {0, 3, 0}};
+
+	constexpr Ray ray {{1, 2, 3}, {0, 1, 0}};
+	constexpr AffineTransform affine{scaling(2.0, 3.0, 4.0)};
+
+	constexpr Ray result = ray.transform(affine);
+	ASSERT_EQUAL(expected, result);
+}
+
+void testTransformChainMatchesEagerProduct() {
+	constexpr auto chain = Transforms::translation(10.0, 5.0, 7.0) * Transforms::rotation_z(pi<double> / 3) * Transforms::scaling(2.0, 3.0, 4.0);
+	constexpr auto eager = translation(10.0, 5.0, 7.0) * rotation_z(pi<double> / 3) * scaling(2.0, 3.0, 4.0);
+	ASSERT_EQUAL(eager, chain.matrix());
+}
+
+void testTransformChainInverseMatchesGeneralInverse() {
+	constexpr auto chain = Transforms::translation(5.0, -3.0, 2.0) * Transforms::rotation_x(pi<double> / 5) * Transforms::rotation_y(pi<double> / 7) * Transforms::scaling(2.0, 0.5, 4.0);
+	ASSERT_EQUAL(inverse(chain.matrix()), chain.inverse());
+	ASSERT_EQUAL(identity<4>, chain.matrix() * chain.inverse());
+}
+
+void testTransformChainInverseOfShearing() {
+	constexpr auto chain = Transforms::shearing(1.0, 0.5, 0.0, 0.0, 0.25, 0.0) * Transforms::translation(1.0, 2.0, 3.0);
+	ASSERT_EQUAL(inverse(chain.matrix()), chain.inverse());
+}
+
+void testTransformChainAppliedToPointWithoutMatrix() {
+	constexpr auto chain = Transforms::translation(10.0, 5.0, 7.0) * Transforms::scaling(5.0, 5.0, 5.0) * Transforms::rotation_x(pi<double> / 2.0);
+	constexpr Point initial{1.0, 0.0, 1.0};
+	constexpr Point expected{15.0, 0.0, 7.0};
+	ASSERT_EQUAL(expected, chain * initial);
+	ASSERT_EQUAL(chain.matrix() * initial, chain * initial);
+}
+
+void testTransformChainIgnoresTranslationForDirections() {
+	constexpr auto chain = Transforms::translation(10.0, 5.0, 7.0) * Transforms::shearing(0.0, 0.0, 0.0, 0.0, 0.0, 1.0);
+	constexpr Direction direction{2.0, 3.0, 4.0};
+	constexpr Direction expected{2.0, 3.0, 7.0};
+	ASSERT_EQUAL(expected, chain * direction);
+}
+
+void testSingularTransformChainThrowsOnInverse() {
+	constexpr auto chain = Transforms::rotation_z(pi<double> / 4) * Transforms::scaling(0.0, 100.0, 0.0);
+	ASSERT_THROWS(chain.inverse(), std::invalid_argument);
+}
+
+void testTransformFromChainUsesAnalyticInverse() {
+	constexpr auto chain = Transforms::translation(0.0, 1.0, 0.0) * Transforms::scaling(2.0, 2.0, 2.0);
+	constexpr Shapes::Sphere sphere{{}, chain};
+	ASSERT_EQUAL(chain.matrix(), sphere.transform.matrix());
+	ASSERT_EQUAL(chain.inverse(), sphere.transform.inverse());
+	ASSERT_EQUAL(transpose(chain.inverse()), sphere.transform.inverseTranspose());
+}
+
+void testSimilarityScaleOfSimilarities() {
+	ASSERT_EQUAL(1.0, Transform{}.similarityScale());
+	ASSERT_EQUAL(1.0, Transform{translation(1.0, -2.0, 3.0)}.similarityScale());
+	ASSERT_EQUAL(1.0, Transform{scaling(-1.0, 1.0, 1.0)}.similarityScale());
+	ASSERT_EQUAL_DELTA(2.5, Transform{translation(1.0, 2.0, 3.0) * rotation_x(0.3) * rotation_y(1.1) * scaling(2.5, 2.5, 2.5)}.similarityScale(), 1e-12);
+	constexpr auto chain = Transforms::translation(0.0, 1.0, 0.0) * Transforms::scaling(2.0, 2.0, 2.0);
+	constexpr Transform fromChain{chain};
+	ASSERT_EQUAL(2.0, fromChain.similarityScale());
+}
+
+void testNoSimilarityScaleForDistortingTransforms() {
+	ASSERT_EQUAL(0.0, Transform{scaling(1.0, 2.0, 1.0)}.similarityScale());
+	ASSERT_EQUAL(0.0, Transform{shearing(0.5, 0.0, 0.0, 0.0, 0.0, 0.0)}.similarityScale());
+	ASSERT_EQUAL(0.0, Transform{scaling(0.0, 0.0, 0.0)}.similarityScale());
+	ASSERT_EQUAL(0.0, Transform{scaling(1.0, 1.0, 1.0 + 1e-9)}.similarityScale());
+}
+
+void testSinglePrecisionTransformChain() {
+	constexpr auto chain = Transforms::translation(1.0f, 2.0f, 3.0f) * Transforms::rotation_y(pi<float> / 2);
+	constexpr PointF point{0.0f, 0.0f, 1.0f};
+	constexpr PointF expected{2.0f, 2.0f, 3.0f};
+	ASSERT_EQUAL(expected, chain * point);
+}
+
 cute::suite make_suite_TransformationsTestSuite() {
 	cute::suite s { };
 	s.push_back(CUTE(testTranslationMatrix));
@@ -218,5 +382,28 @@ cute::suite make_suite_TransformationsTestSuite() {
 	s.push_back(CUTE(testChainingTransformations));
 	s.push_back(CUTE(testTranslatingARay));
 	s.push_back(CUTE(testScalingARay));
+	s.push_back(CUTE(testTransformCachesInverse));
+	s.push_back(CUTE(testTransformCachesInverseTranspose));
+	s.push_back(CUTE(testDefaultTransformIsIdentity));
+	s.push_back(CUTE(testSingularTransformThrowsOnInverseAccess));
+	s.push_back(CUTE(testRayToObjectSpace));
+	s.push_back(CUTE(testAffineTransformRoundTripsMatrix));
+	s.push_back(CUTE(testAffineTransformRejectsProjectiveMatrix));
+	s.push_back(CUTE(testAffineTransformStoresTwelveValues));
+	s.push_back(CUTE(testAffineCompositionMatchesMatrixProduct));
+	s.push_back(CUTE(testAffineTransformAppliedToPointAndDirection));
+	s.push_back(CUTE(testAffineInverseMatchesMatrixInverse));
+	s.push_back(CUTE(testAffineInverseOfSingularTransformThrows));
+	s.push_back(CUTE(testTransformingARayWithAffineTransform));
+	s.push_back(CUTE(testTransformChainMatchesEagerProduct));
+	s.push_back(CUTE(testTransformChainInverseMatchesGeneralInverse));
+	s.push_back(CUTE(testTransformChainInverseOfShearing));
+	s.push_back(CUTE(testTransformChainAppliedToPointWithoutMatrix));
+	s.push_back(CUTE(testTransformChainIgnoresTranslationForDirections));
+	s.push_back(CUTE(testSingularTransformChainThrowsOnInverse));
+	s.push_back(CUTE(testTransformFromChainUsesAnalyticInverse));
+	s.push_back(CUTE(testSinglePrecisionTransformChain));
+	s.push_back(CUTE(testSimilarityScaleOfSimilarities));
+	s.push_back(CUTE(testNoSimilarityScaleForDistortingTransforms));
 	return s;
 }
@@ -0,0 +1,165 @@
+#include "WorldTestSuite.h"
+#include "Color.h"
+#include "Intersections.h"
+#include "Light.h"
+#include "Occlusion.h"
+#include "Point.h"
+#include "Ray.h"
+#include "Sphere.h"
+#include "Transformations.h"
+#include "World.h"
+#include "cute.h"
+
+#include <random>
+#include <vector>
+
+
+using Shapes::Sphere;
+
+namespace {
+
+World defaultWorld() {
+	World world{};
+	world.add(Light{{-10.0, 10.0, -10.0}, Colors::white});
+	world.add(Sphere{});
+	world.add(Sphere{{}, scaling(0.5, 0.5, 0.5)});
+	return world;
+}
+
+}
+
+void testEmptyWorldHasNoIntersections() {
+	World const world{};
+	constexpr Ray ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}};
+	ASSERT(world.intersect(ray).empty());
+	ASSERT(world.lights().empty());
+}
+
+void testWorldOwnsShapesAndLights() {
+	auto const world = defaultWorld();
+	ASSERT_EQUAL(2u, world.scene().size());
+	ASSERT_EQUAL(1u, world.lights().size());
+}
+
+void testIntersectWorldWithRay() {
+	auto const world = defaultWorld();
+	constexpr Ray ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}};
+	IntersectionBuffer const expected{
+		Intersection{4.0, ShapeId{0}},
+		Intersection{4.5, ShapeId{1}},
+		Intersection{5.5, ShapeId{1}},
+		Intersection{6.0, ShapeId{0}}
+	};
+	ASSERT_EQUAL(expected, world.intersect(ray));
+}
+
+void testIntersectWorldReusesBuffer() {
+	auto const world = defaultWorld();
+	constexpr Ray ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}};
+	IntersectionBuffer buffer{};
+	buffer.reserve(8);
+	auto const * const storage = buffer.data();
+	world.intersect(ray, buffer);
+	world.intersect(Ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}}, buffer);
+	ASSERT_EQUAL(4u, buffer.size());
+	ASSERT_EQUAL(storage, buffer.data());
+}
+
+void testIntersectWorldClearsPreviousResults() {
+	auto const world = defaultWorld();
+	IntersectionBuffer buffer{};
+	world.intersect(Ray{{0.0, 0.0, -5.0}, {0.0, 0.0, 1.0}}, buffer);
+	world.intersect(Ray{{0.0, 5.0, -5.0}, {0.0, 0.0, 1.0}}, buffer);
+	ASSERT(buffer.empty());
+}
+
+void testHitInWorldFromInsideSphere() {
+	auto const world = defaultWorld();
+	constexpr Ray ray{{0.0, 0.0, 0.0}, {0.0, 0.0, 1.0}};
+	auto const intersections = world.intersect(ray);
+	auto const firstHit = hit(intersections);
+	ASSERT_EQUAL(4u, intersections.size());
+	ASSERT_EQUAL((Intersection{0.5, ShapeId{1}}), firstHit.value());
+}
+
+void testNoShadowWhenNothingIsBetweenPointAndLight() {
+	auto const world = defaultWorld();
+	auto const & light = world.lights().front();
+	for (auto const & point : {Point{0.0, 10.0, 0.0}, Point{-20.0, 20.0, -20.0}, Point{-2.0, 2.0, -2.0}}) {
+		ASSERT(!isOccluded(world.scene().spheres(), point, light));
+		ASSERT(!world.isOccluded(point, light));
+	}
+}
+
+void testShadowWhenShapeIsBetweenPointAndLight() {
+	auto const world = defaultWorld();
+	constexpr Point point{10.0, -10.0, 10.0};
+	OcclusionCounters counters{};
+	ASSERT(isOccluded(world.scene().spheres(), point, world.lights().front(), counters));
+	ASSERT(world.isOccluded(point, world.lights().front(), counters));
+	ASSERT_EQUAL(2u, counters.queries);
+	ASSERT_EQUAL(2u, counters.occluded);
+}
+
+void testOcclusionStopsAtFirstBlockingShape() {
+	auto const world = defaultWorld();
+	OcclusionCounters counters{};
+	isOccluded(world.scene().spheres(), Point{10.0, -10.0, 10.0}, world.lights().front(), counters);
+	ASSERT_EQUAL(1u, counters.shapesTested);
+	isOccluded(world.scene().spheres(), Point{0.0, 10.0, 0.0}, world.lights().front(), counters);
+	ASSERT_EQUAL(3u, counters.shapesTested);
+}
+
+void testOccludedWithAcceleratorMatchesShapes() {
+	std::mt19937 generator{3};
+	std::uniform_real_distribution<double> coordinate{-10.0, 10.0};
+	World world{};
+	for (auto index = 0; index < 200; ++index) {
+		world.add(Sphere{{}, translation(coordinate(generator), coordinate(generator), coordinate(generator)) * scaling(0.5, 0.5, 0.5)});
+	}
+	world.buildBvh();
+	constexpr Light light{{0.0, 20.0, 0.0}, Colors::white};
+	OcclusionCounters linear{};
+	OcclusionCounters accelerated{};
+	for (auto index = 0; index < 500; ++index) {
+		Point const point{coordinate(generator), coordinate(generator), coordinate(generator)};
+		ASSERT_EQUAL(isOccluded(world.scene().spheres(), point, light, linear), world.isOccluded(point, light, accelerated));
+	}
+	ASSERT_EQUAL(linear.occluded, accelerated.occluded);
+	ASSERT(accelerated.shapesTested < linear.shapesTested);
+}
+
+void testOccludedOverSceneMatchesShapes() {
+	std::mt19937 generator{4};
+	std::uniform_real_distribution<double> coordinate{-10.0, 10.0};
+	World world{};
+	for (auto index = 0; index < 200; ++index) {
+		world.add(Sphere{{}, translation(coordinate(generator), coordinate(generator), coordinate(generator)) * scaling(0.5, 1.5, 0.5)});
+	}
+	constexpr Light light{{0.0, 20.0, 0.0}, Colors::white};
+	OcclusionCounters shapes{};
+	OcclusionCounters scene{};
+	for (auto index = 0; index < 500; ++index) {
+		Point const point{coordinate(generator), coordinate(generator), coordinate(generator)};
+		ASSERT_EQUAL(isOccluded(world.scene().spheres(), point, light, shapes), isOccluded(world.scene(), point, light, scene));
+	}
+	ASSERT(scene.occluded > 0);
+	ASSERT_EQUAL(shapes.occluded, scene.occluded);
+	ASSERT(scene.shapesTested < shapes.shapesTested);
+}
+
+cute::suite make_suite_WorldTestSuite() {
+	cute::suite s { };
+	s.push_back(CUTE(testEmptyWorldHasNoIntersections));
+	s.push_back(CUTE(testWorldOwnsShapesAndLights));
+	s.push_back(CUTE(testIntersectWorldWithRay));
+	s.push_back(CUTE(testIntersectWorldReusesBuffer));
+	s.push_back(CUTE(testIntersectWorldClearsPreviousResults));
+	s.push_back(CUTE(testHitInWorldFromInsideSphere));
+	s.push_back(CUTE(testNoShadowWhenNothingIsBetweenPointAndLight));
+	s.push_back(CUTE(testShadowWhenShapeIsBetweenPointAndLight));
+	s.push_back(CUTE(testOcclusionStopsAtFirstBlockingShape));
+	s.push_back(CUTE(testOccludedWithAcceleratorMatchesShapes));
+	s.push_back(CUTE(testOccludedOverSceneMatchesShapes));
+	return s;
+}
@@ -0,0 +1,8 @@
+#ifndef WORLDTESTSUITE_H_
+#define WORLDTESTSUITE_H_
+
+#include "cute_suite.h"
+
+extern cute::suite make_suite_WorldTestSuite();
+
+#endif /* WORLDTESTSUITE_H_ */